@@ -0,0 +1,73 @@
+#include <boost/test/unit_test.hpp>
+#include <silicium/sink/append.hpp>
+#include <ventura/open.hpp>
+#include <ventura/sink/buffered_file_sink.hpp>
+#if SILICIUM_HAS_EXCEPTIONS
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#endif
+
+#if SILICIUM_HAS_EXCEPTIONS && VENTURA_HAS_FILE_SINK
+namespace
+{
+    std::string read_whole_file(boost::filesystem::path const &name)
+    {
+        std::ifstream file(name.string(), std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_sink_coalesces)
+{
+    boost::filesystem::path const file_name =
+        boost::filesystem::temp_directory_path() / "ventura_buffered_file_sink_coalesces.txt";
+    std::string expected;
+    {
+        Si::file_handle file = ventura::overwrite_file(Si::native_path_string(file_name.c_str())).move_value();
+        ventura::buffered_file_sink sink(file.handle, 16);
+        for (int i = 0; i < 100; ++i)
+        {
+            BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("abc")}));
+            expected += "abc";
+        }
+        BOOST_CHECK_EQUAL(300u % 16u, sink.buffered_size());
+
+        // larger than the buffer
+        std::string const large(40, 'x');
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_memory_range(large)}));
+        expected += large;
+        BOOST_CHECK_EQUAL(0u, sink.buffered_size());
+
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("tail")}));
+        BOOST_CHECK_EQUAL(4u, sink.buffered_size());
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{ventura::flush{}}));
+        BOOST_CHECK_EQUAL(0u, sink.buffered_size());
+        expected += "tail";
+        BOOST_CHECK_EQUAL(expected, read_whole_file(file_name));
+
+        // a seek writes the buffer first
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("end")}));
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{ventura::seek_set{0}}));
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("A")}));
+        expected += "end";
+        expected[0] = 'A';
+    }
+    // the destructor writes the rest
+    BOOST_CHECK_EQUAL(expected, read_whole_file(file_name));
+}
+
+BOOST_AUTO_TEST_CASE(buffered_file_sink_drops_buffer_after_failed_write)
+{
+    boost::filesystem::path const file_name =
+        boost::filesystem::temp_directory_path() / "ventura_buffered_file_sink_failure.txt";
+    ventura::overwrite_file(Si::native_path_string(file_name.c_str())).move_value();
+    // writing to a file that is only open for reading fails
+    Si::file_handle file = ventura::open_reading(Si::native_path_string(file_name.c_str())).move_value();
+    ventura::buffered_file_sink sink(file.handle, 16);
+    BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("abc")}));
+    BOOST_CHECK_EQUAL(3u, sink.buffered_size());
+    BOOST_CHECK(!!sink.flush_buffer());
+    BOOST_CHECK_EQUAL(0u, sink.buffered_size());
+    BOOST_CHECK(!sink.flush_buffer());
+}
+#endif
@@ -0,0 +1,130 @@
+#include <boost/test/unit_test.hpp>
+#include <silicium/sink/append.hpp>
+#include <ventura/sink/direct_file_sink.hpp>
+#include <ventura/source/direct_file_source.hpp>
+#include <cstdint>
+#if SILICIUM_HAS_EXCEPTIONS
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#endif
+
+BOOST_AUTO_TEST_CASE(aligned_buffer_pool_recycles)
+{
+    ventura::aligned_buffer_pool pool(8192, 4096);
+    char *first_address = nullptr;
+    {
+        ventura::pooled_buffer const first = pool.acquire();
+        BOOST_REQUIRE(first.data());
+        BOOST_CHECK_EQUAL(8192u, first.size());
+        BOOST_CHECK_EQUAL(0u, reinterpret_cast<std::uintptr_t>(first.data()) % 4096u);
+        first_address = first.data();
+        BOOST_CHECK_EQUAL(0u, pool.idle_buffers());
+    }
+    BOOST_CHECK_EQUAL(1u, pool.idle_buffers());
+    ventura::pooled_buffer second = pool.acquire();
+    BOOST_CHECK_EQUAL(first_address, second.data());
+    ventura::pooled_buffer moved = std::move(second);
+    BOOST_CHECK(!second.data());
+    BOOST_CHECK_EQUAL(first_address, moved.data());
+}
+
+#if SILICIUM_HAS_EXCEPTIONS && VENTURA_HAS_DIRECT_IO
+namespace
+{
+    /// The temporary directory is often on tmpfs, which does not support O_DIRECT, so the current directory is tried
+    /// as well.
+    /// @return none if the test has to be skipped
+    Si::optional<boost::filesystem::path> find_direct_io_file(char const *name)
+    {
+        for (boost::filesystem::path const &directory :
+             {boost::filesystem::temp_directory_path(), boost::filesystem::current_path()})
+        {
+            boost::filesystem::path const file_name = directory / name;
+            Si::error_or<Si::file_handle> const opened =
+                ventura::overwrite_file_direct(Si::native_path_string(file_name.c_str()));
+            if (!opened.is_error())
+            {
+                return file_name;
+            }
+            BOOST_REQUIRE(opened.error() == boost::system::errc::invalid_argument);
+        }
+        BOOST_TEST_MESSAGE("skipped: neither the temporary nor the current directory supports O_DIRECT");
+        return Si::none;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(direct_file_sink_and_source)
+{
+    Si::optional<boost::filesystem::path> const found = find_direct_io_file("ventura_direct_io.txt");
+    if (!found)
+    {
+        return;
+    }
+    boost::filesystem::path const &file_name = *found;
+    Si::file_handle file =
+        ventura::overwrite_file_direct(Si::native_path_string(file_name.c_str())).move_value();
+    ventura::aligned_buffer_pool pool(4096, 4096);
+    std::string expected;
+    {
+        ventura::direct_file_sink sink(file.handle, pool);
+        for (int i = 0; expected.size() < 10000; ++i)
+        {
+            std::string const line = std::to_string(i) + "\n";
+            BOOST_REQUIRE(!Si::append(sink, Si::make_iterator_range(line.data(), line.data() + line.size())));
+            expected += line;
+        }
+        BOOST_CHECK_EQUAL(expected.size() % 4096u, sink.buffered_size());
+        BOOST_REQUIRE(!sink.finish());
+        BOOST_CHECK_EQUAL(0u, sink.buffered_size());
+    }
+    BOOST_CHECK_EQUAL(1u, pool.idle_buffers());
+    {
+        std::ifstream written(file_name.string(), std::ios::binary);
+        BOOST_CHECK_EQUAL(
+            expected, std::string((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>()));
+    }
+
+    Si::file_handle const reading =
+        ventura::open_reading_direct(Si::native_path_string(file_name.c_str())).move_value();
+    auto source = ventura::make_direct_file_source(reading.handle, pool.acquire());
+    BOOST_CHECK_EQUAL(0u, pool.idle_buffers());
+    std::string read;
+    for (;;)
+    {
+        auto piece = Si::get(source);
+        if (!piece)
+        {
+            break;
+        }
+        Si::memory_range const content = piece->get();
+        read.append(content.begin(), content.end());
+    }
+    BOOST_CHECK_EQUAL(expected, read);
+}
+
+BOOST_AUTO_TEST_CASE(direct_file_sink_append_after_aligned_finish)
+{
+    Si::optional<boost::filesystem::path> const found = find_direct_io_file("ventura_direct_io_finished.txt");
+    if (!found)
+    {
+        return;
+    }
+    boost::filesystem::path const &file_name = *found;
+    Si::file_handle file =
+        ventura::overwrite_file_direct(Si::native_path_string(file_name.c_str())).move_value();
+    ventura::aligned_buffer_pool pool(4096, 4096);
+    std::string const aligned(4096, 'a');
+    std::string const tail = "tail";
+    {
+        ventura::direct_file_sink sink(file.handle, pool);
+        BOOST_REQUIRE(!Si::append(sink, Si::make_iterator_range(aligned.data(), aligned.data() + aligned.size())));
+        BOOST_CHECK_EQUAL(0u, sink.buffered_size());
+        BOOST_REQUIRE(!sink.finish());
+        // O_DIRECT would reject this write because of its size
+        BOOST_REQUIRE(!Si::append(sink, Si::make_iterator_range(tail.data(), tail.data() + tail.size())));
+    }
+    std::ifstream written(file_name.string(), std::ios::binary);
+    BOOST_CHECK_EQUAL(aligned + tail,
+                      std::string((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>()));
+}
+#endif
@@ -0,0 +1,131 @@
+#include <boost/test/unit_test.hpp>
+#include <silicium/sink/append.hpp>
+#include <ventura/open.hpp>
+#include <ventura/sink/file_sink.hpp>
+#if VENTURA_HAS_DURABILITY_COORDINATOR && VENTURA_HAS_FILE_SINK && SILICIUM_HAS_EXCEPTIONS
+#include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#endif
+
+#if VENTURA_HAS_DURABILITY_COORDINATOR && VENTURA_HAS_FILE_SINK && SILICIUM_HAS_EXCEPTIONS
+namespace
+{
+    boost::filesystem::path journal_name(std::size_t index)
+    {
+        return boost::filesystem::temp_directory_path() /
+               ("ventura_durability_coordinator_" + boost::lexical_cast<std::string>(index));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(durability_coordinator_groups_flushes)
+{
+    ventura::durability_coordinator coordinator(ventura::durability_mode::data_sync, std::chrono::milliseconds(100));
+    std::size_t const writers = 8;
+    // the writers share two descriptors, so the flushes of a group need at most one system call per descriptor
+    std::vector<Si::file_handle> files;
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        files.emplace_back(ventura::overwrite_file(Si::native_path_string(journal_name(i).c_str())).move_value());
+    }
+    std::vector<boost::system::error_code> errors(writers);
+    std::atomic<std::size_t> waiting(writers);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < writers; ++i)
+    {
+        threads.emplace_back([&coordinator, &errors, &files, &waiting, i]()
+                             {
+                                 ventura::file_sink sink(files[i % files.size()].handle);
+                                 sink.set_durability_coordinator(&coordinator);
+                                 errors[i] = Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("x")});
+                                 // all writers flush at about the same time
+                                 --waiting;
+                                 while (waiting.load() > 0)
+                                 {
+                                     std::this_thread::yield();
+                                 }
+                                 if (!errors[i])
+                                 {
+                                     errors[i] = Si::append(sink, ventura::file_sink_element{ventura::flush{}});
+                                 }
+                             });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    for (boost::system::error_code const &error : errors)
+    {
+        BOOST_CHECK_EQUAL(boost::system::error_code(), error);
+    }
+    BOOST_CHECK_EQUAL(writers, coordinator.requests());
+    BOOST_CHECK_GE(coordinator.system_calls(), 1u);
+    BOOST_CHECK_LT(coordinator.system_calls(), coordinator.requests());
+}
+
+BOOST_AUTO_TEST_CASE(durability_coordinator_groups_many_files)
+{
+    ventura::durability_coordinator coordinator(ventura::durability_mode::data_sync, std::chrono::milliseconds(100));
+    std::size_t const journals = 8;
+    std::vector<Si::file_handle> files;
+    std::vector<ventura::file_sink> sinks;
+    for (std::size_t i = 0; i < journals; ++i)
+    {
+        files.emplace_back(
+            ventura::overwrite_file(Si::native_path_string(journal_name(10 + i).c_str())).move_value());
+        sinks.emplace_back(files.back().handle);
+    }
+    std::vector<std::future<boost::system::error_code>> committed;
+    for (ventura::file_sink &sink : sinks)
+    {
+        sink.set_durability_coordinator(&coordinator);
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("record")}));
+        auto promise = std::make_shared<std::promise<boost::system::error_code>>();
+        committed.emplace_back(promise->get_future());
+        sink.request_commit([promise](boost::system::error_code error)
+                            {
+                                promise->set_value(error);
+                            });
+    }
+    for (std::future<boost::system::error_code> &result : committed)
+    {
+        BOOST_CHECK_EQUAL(boost::system::error_code(), result.get());
+    }
+    BOOST_CHECK_EQUAL(journals, coordinator.requests());
+#ifdef __linux__
+    // the journals are in the same directory, so one syncfs covers all of them
+    BOOST_CHECK_EQUAL(1u, coordinator.system_calls());
+#else
+    BOOST_CHECK_EQUAL(journals, coordinator.system_calls());
+#endif
+}
+
+BOOST_AUTO_TEST_CASE(durability_coordinator_asynchronous_commit)
+{
+    std::atomic<int> committed(0);
+    {
+        Si::file_handle file =
+            ventura::open_synchronous_writing(Si::native_path_string(journal_name(2).c_str())).move_value();
+        ventura::durability_coordinator coordinator(ventura::durability_mode::synchronous_writes);
+        ventura::file_sink sink(file.handle);
+        sink.set_durability_coordinator(&coordinator);
+        for (int i = 0; i < 10; ++i)
+        {
+            BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("record")}));
+            sink.request_commit([&committed](boost::system::error_code error)
+                                {
+                                    if (!error)
+                                    {
+                                        ++committed;
+                                    }
+                                });
+        }
+        BOOST_CHECK_EQUAL(0u, coordinator.system_calls());
+    }
+    // the destructor of the coordinator completes all requests
+    BOOST_CHECK_EQUAL(10, committed.load());
+}
+#endif
@@ -0,0 +1,33 @@
+#include <boost/test/unit_test.hpp>
+#include <silicium/sink/iterator_sink.hpp>
+#include <silicium/sink/virtualized_sink.hpp>
+#include <ventura/executable_handle.hpp>
+#include <ventura/file_operations.hpp>
+
+#if VENTURA_HAS_EXECUTABLE_HANDLE
+BOOST_AUTO_TEST_CASE(executable_cache_resolves_once)
+{
+    ventura::executable_cache executables(std::chrono::hours(1));
+    std::shared_ptr<ventura::executable_handle const> const first = executables.resolve("sh").move_value();
+    BOOST_REQUIRE(first);
+    BOOST_CHECK_GE(first->file(), 0);
+    BOOST_CHECK(!first->is_stale());
+    BOOST_CHECK_EQUAL(first, executables.resolve("sh").get());
+    BOOST_CHECK(executables.resolve("ventura-no-such-executable").is_error());
+}
+
+BOOST_AUTO_TEST_CASE(executable_cache_run_process)
+{
+    ventura::executable_cache executables;
+    ventura::process_parameters parameters;
+    parameters.arguments.emplace_back("-c");
+    parameters.arguments.emplace_back("echo \"$0\"");
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    std::vector<char> out;
+    auto sink = Si::virtualize_sink(Si::make_iterator_sink<char>(std::back_inserter(out)));
+    parameters.out = &sink;
+    BOOST_REQUIRE_EQUAL(0, ventura::run_process(executables, "sh", parameters).get());
+    std::string const expected = executables.resolve("sh").get()->path().c_str() + std::string("\n");
+    BOOST_CHECK_EQUAL(expected, std::string(out.begin(), out.end()));
+}
+#endif
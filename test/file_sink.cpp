@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <array>
 #include <boost/test/unit_test.hpp>
 #include <boost/thread/future.hpp>
@@ -48,6 +49,124 @@ BOOST_AUTO_TEST_CASE(file_sink_success)
     std::string const expected = "tesaaabbbbccccc";
     BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), content.begin(), content.end());
 }
+
+#ifndef _WIN32
+BOOST_AUTO_TEST_CASE(file_sink_positional)
+{
+    boost::filesystem::path const file_name =
+        boost::filesystem::temp_directory_path() / "ventura_file_sink_positional.txt";
+    {
+        Si::file_handle file = get(ventura::overwrite_file(Si::native_path_string(file_name.c_str())));
+        ventura::file_sink sink(file.handle, ventura::positional_writes{2});
+        std::array<ventura::file_sink_element, 7> const elements{
+            {Si::make_c_str_range("header"), Si::make_c_str_range("body"), ventura::seek_set{0},
+             Si::make_c_str_range("__"), ventura::seek_add{2}, Si::make_c_str_range("A"), ventura::seek_add{-2}}};
+        BOOST_CHECK_EQUAL(boost::system::error_code(),
+                          sink.append(make_iterator_range(elements.data(), elements.data() + elements.size())));
+        BOOST_CHECK_EQUAL(3u, *sink.cursor());
+        BOOST_CHECK_EQUAL(boost::system::error_code(EINVAL, boost::system::system_category()),
+                          Si::append(sink, ventura::file_sink_element{ventura::seek_add{-5}}));
+
+        // the cursor of the file descriptor is not used
+        BOOST_CHECK_EQUAL(0, lseek(file.handle, 0, SEEK_CUR));
+    }
+    std::vector<char> content = read_file(file_name);
+    std::string const expected = "__heAderbody";
+    BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), content.begin(), content.end());
+}
+
+BOOST_AUTO_TEST_CASE(file_sink_space_management)
+{
+    boost::filesystem::path const file_name =
+        boost::filesystem::temp_directory_path() / "ventura_file_sink_space_management.txt";
+    std::string expected = "0123456789";
+    {
+        Si::file_handle file = get(ventura::overwrite_file(Si::native_path_string(file_name.c_str())));
+        ventura::file_sink sink(file.handle);
+        BOOST_REQUIRE_EQUAL(boost::system::error_code(),
+                            Si::append(sink, ventura::file_sink_element{Si::make_memory_range(expected)}));
+
+        boost::system::error_code const reserved =
+            Si::append(sink, ventura::file_sink_element{ventura::reserve_space{0, 1024 * 1024}});
+        BOOST_CHECK(!reserved || (reserved == boost::system::errc::not_supported));
+        BOOST_CHECK_EQUAL(10u, boost::filesystem::file_size(file_name));
+
+        boost::system::error_code const punched =
+            Si::append(sink, ventura::file_sink_element{ventura::punch_hole{2, 3}});
+        BOOST_CHECK(!punched || (punched == boost::system::errc::not_supported));
+        if (!punched)
+        {
+            std::fill(expected.begin() + 2, expected.begin() + 5, '\0');
+        }
+
+        BOOST_REQUIRE_EQUAL(boost::system::error_code(),
+                            Si::append(sink, ventura::file_sink_element{ventura::truncate_file{7}}));
+        expected.resize(7);
+
+        // the cursor stays behind the end
+        BOOST_CHECK_EQUAL(10, lseek(file.handle, 0, SEEK_CUR));
+    }
+    std::vector<char> content = read_file(file_name);
+    BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), content.begin(), content.end());
+}
+#endif
+
+#if VENTURA_HAS_ACCESS_HINTS
+BOOST_AUTO_TEST_CASE(file_sink_streaming)
+{
+    boost::filesystem::path const file_name =
+        boost::filesystem::temp_directory_path() / "ventura_file_sink_streaming.txt";
+    std::vector<char> const block(1024 * 1024, 's');
+    std::size_t const block_count = 20;
+    {
+        Si::file_handle file = get(ventura::overwrite_file(Si::native_path_string(file_name.c_str())));
+        ventura::file_sink sink(file.handle);
+        sink.set_access_pattern(ventura::access_pattern::streaming);
+        for (std::size_t i = 0; i < block_count; ++i)
+        {
+            BOOST_REQUIRE_EQUAL(boost::system::error_code(),
+                                Si::append(sink, ventura::file_sink_element{Si::make_memory_range(block)}));
+        }
+    }
+    std::vector<char> const content = read_file(file_name);
+    BOOST_REQUIRE_EQUAL(block.size() * block_count, content.size());
+    BOOST_CHECK(std::all_of(content.begin(), content.end(), [](char c)
+                            {
+                                return c == 's';
+                            }));
+}
+
+BOOST_AUTO_TEST_CASE(file_sink_streaming_with_seeks)
+{
+    boost::filesystem::path const file_name =
+        boost::filesystem::temp_directory_path() / "ventura_file_sink_streaming_with_seeks.txt";
+    std::vector<char> const first(1024 * 1024, 'f');
+    std::vector<char> const second(1024 * 1024, 's');
+    std::size_t const block_count = 12;
+    {
+        Si::file_handle file = get(ventura::overwrite_file(Si::native_path_string(file_name.c_str())));
+        ventura::file_sink sink(file.handle);
+        sink.set_access_pattern(ventura::access_pattern::streaming);
+        // the write-behind window is crossed by writes on both sides of a seek
+        for (std::vector<char> const *block : {&first, &second})
+        {
+            BOOST_REQUIRE_EQUAL(boost::system::error_code(),
+                                Si::append(sink, ventura::file_sink_element{ventura::seek_set{0}}));
+            for (std::size_t i = 0; i < block_count; ++i)
+            {
+                BOOST_REQUIRE_EQUAL(boost::system::error_code(),
+                                    Si::append(sink, ventura::file_sink_element{Si::make_memory_range(*block)}));
+            }
+        }
+    }
+    std::vector<char> const content = read_file(file_name);
+    BOOST_REQUIRE_EQUAL(second.size() * block_count, content.size());
+    BOOST_CHECK(std::all_of(content.begin(), content.end(), [](char c)
+                            {
+                                return c == 's';
+                            }));
+}
+#endif
 #endif
 
 #if VENTURA_HAS_FILE_SINK
@@ -145,5 +264,44 @@ BOOST_AUTO_TEST_CASE(file_sink_writev)
 
     writer.get();
 }
+
+BOOST_AUTO_TEST_CASE(file_sink_writev_more_pieces_than_iov_max)
+{
+    Si::pipe buffer = Si::make_pipe().move_value();
+    ventura::file_sink sink(buffer.write.handle);
+    std::array<char, 9001> read_buffer;
+    auto source = ventura::make_file_source(buffer.read.handle, Si::make_contiguous_range(read_buffer));
+    std::vector<char> expected;
+    for (std::size_t i = 0; i < 5000; ++i)
+    {
+        expected.insert(expected.end(), i % 7, static_cast<char>('a' + (i % 26)));
+    }
+    std::vector<ventura::file_sink::element_type> writes;
+    for (std::size_t i = 0, begin = 0; i < 5000; begin += i % 7, ++i)
+    {
+        writes.emplace_back(Si::make_memory_range(expected.data() + begin, expected.data() + begin + (i % 7)));
+    }
+
+    auto writer = boost::async([&]()
+                               {
+                                   auto error = sink.append(Si::make_contiguous_range(writes));
+                                   BOOST_CHECK(!error);
+                                   buffer.write.close();
+                               });
+
+    std::vector<char> all_read;
+    for (;;)
+    {
+        auto piece = Si::get(source);
+        if (!piece)
+        {
+            break;
+        }
+        auto piece_buffer = piece->get();
+        all_read.insert(all_read.end(), piece_buffer.begin(), piece_buffer.end());
+    }
+    BOOST_CHECK(expected == all_read);
+    writer.get();
+}
 #endif
 #endif
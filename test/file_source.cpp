@@ -4,8 +4,13 @@
 #include <silicium/source/throwing_source.hpp>
 #include <ventura/open.hpp>
 #include <ventura/source/file_source.hpp>
+#include <ventura/source/readahead_file_source.hpp>
 #include <ventura/write_file.hpp>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 namespace
 {
     Si::file_handle read_test_file()
@@ -47,3 +52,135 @@ BOOST_AUTO_TEST_CASE(file_source_enumerate)
     BOOST_CHECK_EQUAL(Si::none, Si::get(s));
 }
 #endif
+
+#if VENTURA_HAS_WRITE_FILE
+BOOST_AUTO_TEST_CASE(file_source_access_pattern)
+{
+    std::string const content(3 * 1024 * 1024 + 17, 'r');
+    BOOST_REQUIRE(!ventura::write_file(Si::native_path_string(SILICIUM_SYSTEM_LITERAL("test.txt")),
+                                       Si::make_memory_range(content)));
+    for (ventura::access_pattern pattern :
+         {ventura::access_pattern::normal, ventura::access_pattern::sequential, ventura::access_pattern::streaming})
+    {
+        auto f = ventura::open_reading(Si::native_path_string(SILICIUM_SYSTEM_LITERAL("test.txt"))).move_value();
+        std::vector<char> buffer(64 * 1024);
+        auto s = ventura::make_file_source(
+            f.handle, Si::make_iterator_range(buffer.data(), buffer.data() + buffer.size()), pattern);
+        std::size_t total = 0;
+        for (;;)
+        {
+            auto piece = Si::get(s);
+            if (!piece)
+            {
+                break;
+            }
+            total += static_cast<std::size_t>(piece->get().size());
+        }
+        BOOST_CHECK_EQUAL(content.size(), total);
+    }
+}
+#endif
+
+#if VENTURA_HAS_WRITE_FILE
+BOOST_AUTO_TEST_CASE(readahead_file_source)
+{
+    std::string content(1000 * 1000 + 3, '\0');
+    for (std::size_t i = 0; i < content.size(); ++i)
+    {
+        content[i] = static_cast<char>(i % 251);
+    }
+    BOOST_REQUIRE(!ventura::write_file(Si::native_path_string(SILICIUM_SYSTEM_LITERAL("test.txt")),
+                                       Si::make_memory_range(content)));
+    auto f = ventura::open_reading(Si::native_path_string(SILICIUM_SYSTEM_LITERAL("test.txt"))).move_value();
+    auto s = ventura::make_readahead_file_source(f.handle, 4096, 4);
+    std::string read;
+    for (;;)
+    {
+        auto piece = Si::get(s);
+        if (!piece)
+        {
+            break;
+        }
+        Si::memory_range const received = piece->get();
+        read.append(received.begin(), received.end());
+    }
+    BOOST_CHECK(content == read);
+    BOOST_CHECK_EQUAL(Si::none, Si::get(s));
+}
+
+BOOST_AUTO_TEST_CASE(readahead_file_source_stops_early)
+{
+    // destroying the source before the end stops the thread that is waiting for a free buffer
+    auto f = read_test_file();
+    auto s = ventura::make_readahead_file_source(f.handle, 100, 2);
+    auto piece = Si::get(s);
+    BOOST_REQUIRE(piece);
+    BOOST_CHECK_EQUAL(100u, static_cast<std::size_t>(piece->get().size()));
+}
+#endif
+
+#if VENTURA_HAS_WRITE_FILE
+BOOST_AUTO_TEST_CASE(file_source_read_into)
+{
+    std::string content(10000, '\0');
+    for (std::size_t i = 0; i < content.size(); ++i)
+    {
+        content[i] = static_cast<char>(i % 241);
+    }
+    BOOST_REQUIRE(!ventura::write_file(Si::native_path_string(SILICIUM_SYSTEM_LITERAL("test.txt")),
+                                       Si::make_memory_range(content)));
+    auto f = ventura::open_reading(Si::native_path_string(SILICIUM_SYSTEM_LITERAL("test.txt"))).move_value();
+    std::array<char, 64> buffer;
+    ventura::file_source source(f.handle, Si::make_iterator_range(buffer.data(), buffer.data() + buffer.size()));
+
+    // smaller than the buffer, so the buffer is filled and only a part of it is copied
+    std::array<char, 20> small;
+    BOOST_REQUIRE_EQUAL(small.size(),
+                        source.read_into(Si::make_iterator_range(small.data(), small.data() + small.size())).get());
+    std::string read(small.begin(), small.end());
+
+    // the rest of the buffer
+    Si::memory_range const buffered = source.next().get();
+    BOOST_CHECK_EQUAL(static_cast<std::ptrdiff_t>(buffer.size() - small.size()), buffered.size());
+    read.append(buffered.begin(), buffered.end());
+
+    BOOST_REQUIRE_EQUAL(small.size(),
+                        source.read_into(Si::make_iterator_range(small.data(), small.data() + small.size())).get());
+    read.append(small.begin(), small.end());
+
+    // larger than the buffer and than the rest of the file, which continues with the buffered rest and then reads
+    // directly into the destination
+    std::vector<char> large(20000);
+    std::size_t const rest =
+        source.read_into(Si::make_iterator_range(large.data(), large.data() + large.size())).get();
+    read.append(large.begin(), large.begin() + static_cast<std::ptrdiff_t>(rest));
+    BOOST_CHECK(content == read);
+    BOOST_CHECK(source.next().get().empty());
+}
+#endif
+
+#if VENTURA_HAS_WRITE_FILE && !defined(_WIN32)
+BOOST_AUTO_TEST_CASE(file_source_read_into_keeps_partial_count)
+{
+    BOOST_REQUIRE(!ventura::write_file(Si::native_path_string("test.txt"), Si::make_c_str_range("abcdefgh")));
+    auto f = ventura::open_reading(Si::native_path_string("test.txt")).move_value();
+    std::array<char, 4> buffer;
+    ventura::file_source source(f.handle, Si::make_iterator_range(buffer.data(), buffer.data() + buffer.size()));
+    std::array<char, 2> small;
+    BOOST_REQUIRE_EQUAL(small.size(),
+                        source.read_into(Si::make_iterator_range(small.data(), small.data() + small.size())).get());
+
+    // reading from a directory fails with EISDIR after the buffered "cd" has been copied
+    auto directory = ventura::open_reading(Si::native_path_string(".")).move_value();
+    BOOST_REQUIRE(dup2(directory.handle, f.handle) >= 0);
+    std::array<char, 8> large;
+    Si::error_or<std::size_t> const partial =
+        source.read_into(Si::make_iterator_range(large.data(), large.data() + large.size()));
+    BOOST_REQUIRE_EQUAL(2u, partial.get());
+    BOOST_CHECK_EQUAL("cd", std::string(large.data(), 2));
+    Si::error_or<std::size_t> const failed =
+        source.read_into(Si::make_iterator_range(large.data(), large.data() + large.size()));
+    BOOST_REQUIRE(failed.is_error());
+    BOOST_CHECK(failed.error() == boost::system::errc::is_a_directory);
+}
+#endif
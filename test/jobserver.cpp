@@ -0,0 +1,48 @@
+#include <boost/test/unit_test.hpp>
+#include <silicium/sink/iterator_sink.hpp>
+#include <silicium/sink/virtualized_sink.hpp>
+#include <ventura/file_operations.hpp>
+#include <ventura/jobserver.hpp>
+
+#if VENTURA_HAS_JOBSERVER
+BOOST_AUTO_TEST_CASE(jobserver_tokens_are_returned)
+{
+    ventura::jobserver_server server = ventura::jobserver_server::create(2).move_value();
+    ventura::jobserver_client client = server.client();
+    {
+        ventura::jobserver_token implicit = client.acquire().move_value();
+        ventura::jobserver_token from_pipe = client.acquire().move_value();
+    }
+    ventura::jobserver_token first = client.acquire().move_value();
+    ventura::jobserver_token second = client.acquire().move_value();
+}
+
+BOOST_AUTO_TEST_CASE(jobserver_parse_makeflags)
+{
+    ventura::jobserver_server server = ventura::jobserver_server::create(3).move_value();
+    Si::optional<ventura::jobserver_client> client =
+        ventura::jobserver_client::from_makeflags(server.makeflags().c_str()).get();
+    BOOST_REQUIRE(client);
+    ventura::jobserver_token token = client->acquire().move_value();
+
+    BOOST_CHECK(!ventura::jobserver_client::from_makeflags("-k -j").get());
+    BOOST_CHECK(ventura::jobserver_client::from_makeflags(" --jobserver-auth=x").is_error());
+}
+
+BOOST_AUTO_TEST_CASE(jobserver_shared_with_child)
+{
+    ventura::jobserver_server server = ventura::jobserver_server::create(4).move_value();
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/bin/sh");
+    parameters.arguments.emplace_back("-c");
+    parameters.arguments.emplace_back("printf '%s' \"$MAKEFLAGS\"");
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    std::vector<char> out;
+    auto sink = Si::virtualize_sink(Si::make_iterator_sink<char>(std::back_inserter(out)));
+    parameters.out = &sink;
+    server.share_with(parameters);
+    ventura::jobserver_client client = server.client();
+    BOOST_CHECK_EQUAL(0, ventura::run_process(client, parameters).get());
+    BOOST_CHECK_EQUAL(server.makeflags(), Si::noexcept_string(out.begin(), out.end()));
+}
+#endif
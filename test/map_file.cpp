@@ -0,0 +1,44 @@
+#include <boost/test/unit_test.hpp>
+#include <ventura/file_operations.hpp>
+#include <ventura/map_file.hpp>
+#include <ventura/write_file.hpp>
+
+#if SILICIUM_HAS_EXCEPTIONS && VENTURA_HAS_MAP_FILE && VENTURA_HAS_WRITE_FILE
+namespace
+{
+    Si::os_string write_test_file(char const *name, Si::memory_range content)
+    {
+        Si::os_string const file = to_os_string(ventura::get_current_working_directory(Si::throw_) / name);
+        Si::throw_if_error(ventura::write_file(Si::native_path_string(file.c_str()), content));
+        return file;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(map_file_content)
+{
+    Si::memory_range const expected = Si::make_c_str_range("Hello, mapping");
+    Si::os_string const file = write_test_file("map_file.txt", expected);
+    for (bool huge_page_alignment : {false, true})
+    {
+        ventura::mapped_file const mapped =
+            ventura::map_file(Si::native_path_string(file.c_str()), ventura::mapping_advice::sequential,
+                              huge_page_alignment)
+                .move_value();
+        BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), mapped.content().begin(),
+                                      mapped.content().end());
+        BOOST_CHECK(!mapped.advise(ventura::mapping_advice::random));
+        if (huge_page_alignment)
+        {
+            BOOST_CHECK_EQUAL(0u, reinterpret_cast<std::uintptr_t>(mapped.data()) % ventura::detail::huge_page_size);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(map_file_empty)
+{
+    Si::os_string const file = write_test_file("map_file_empty.txt", Si::memory_range());
+    ventura::mapped_file const mapped = ventura::map_file(Si::native_path_string(file.c_str())).move_value();
+    BOOST_CHECK_EQUAL(0u, mapped.size());
+    BOOST_CHECK(mapped.content().empty());
+}
+#endif
@@ -0,0 +1,65 @@
+#include <boost/test/unit_test.hpp>
+#include <ventura/file_operations.hpp>
+#include <ventura/mapping_cache.hpp>
+#include <ventura/write_file.hpp>
+
+#if SILICIUM_HAS_EXCEPTIONS && VENTURA_HAS_MAPPING_CACHE && VENTURA_HAS_WRITE_FILE
+namespace
+{
+    ventura::absolute_path write_test_file(char const *name, std::string const &content)
+    {
+        ventura::absolute_path const file = ventura::get_current_working_directory(Si::throw_) / name;
+        Si::throw_if_error(ventura::write_file(Si::native_path_string(file.c_str()), Si::make_memory_range(content)));
+        return file;
+    }
+
+    std::string to_string(ventura::mapping_cache::view const &mapped)
+    {
+        return std::string(mapped->content().begin(), mapped->content().end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mapping_cache_shares_and_revalidates)
+{
+    ventura::absolute_path const file = write_test_file("mapping_cache.txt", "first");
+    ventura::mapping_cache cache(1024);
+    ventura::mapping_cache::view const first = cache.get(file).move_value();
+    BOOST_CHECK_EQUAL("first", to_string(first));
+    BOOST_CHECK_EQUAL(first, cache.get(file).get());
+    BOOST_CHECK_EQUAL(5u, cache.mapped_bytes());
+
+    // a different size is enough to notice the modification regardless of the resolution of the modification time
+    write_test_file("mapping_cache.txt", "second");
+    ventura::mapping_cache::view const second = cache.get(file).move_value();
+    BOOST_CHECK_NE(first, second);
+    BOOST_CHECK_EQUAL("second", to_string(second));
+    BOOST_CHECK_EQUAL(6u, cache.mapped_bytes());
+    BOOST_CHECK_EQUAL(1u, cache.size());
+}
+
+BOOST_AUTO_TEST_CASE(mapping_cache_evicts_least_recently_used)
+{
+    ventura::absolute_path const a = write_test_file("mapping_cache_a.txt", "aaaa");
+    ventura::absolute_path const b = write_test_file("mapping_cache_b.txt", "bbbb");
+    ventura::absolute_path const c = write_test_file("mapping_cache_c.txt", "cccc");
+    ventura::mapping_cache cache(8);
+    ventura::mapping_cache::view const first_a = cache.get(a).move_value();
+    BOOST_REQUIRE(!cache.get(b).is_error());
+    // a becomes the most recently used
+    BOOST_CHECK_EQUAL(first_a, cache.get(a).get());
+    BOOST_REQUIRE(!cache.get(c).is_error());
+    BOOST_CHECK_EQUAL(2u, cache.size());
+    BOOST_CHECK_EQUAL(8u, cache.mapped_bytes());
+    BOOST_CHECK_EQUAL(first_a, cache.get(a).get());
+
+    // larger than the budget, so it is mapped but not cached
+    ventura::absolute_path const large = write_test_file("mapping_cache_large.txt", std::string(100, 'l'));
+    BOOST_CHECK_EQUAL(100u, cache.get(large).get()->size());
+    BOOST_CHECK_EQUAL(2u, cache.size());
+
+    // views stay usable after the cache has dropped them
+    cache.clear();
+    BOOST_CHECK_EQUAL("aaaa", to_string(first_a));
+    BOOST_CHECK_EQUAL(0u, cache.mapped_bytes());
+}
+#endif
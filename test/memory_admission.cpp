@@ -0,0 +1,57 @@
+#include <boost/test/unit_test.hpp>
+#include <ventura/file_operations.hpp>
+#include <ventura/memory_admission.hpp>
+#include <limits>
+
+#if VENTURA_HAS_MEMORY_ADMISSION
+BOOST_AUTO_TEST_CASE(memory_admission_budget)
+{
+    ventura::memory_admission_options options(100);
+    options.default_estimate_bytes = 60;
+    options.maximum_pressure = 100.0;
+    ventura::memory_admission_controller controller(options);
+
+    // the first command is always admitted, even if it exceeds the budget alone
+    controller.record("huge", 1000);
+    Si::optional<ventura::memory_reservation> huge = controller.try_admit("huge");
+    BOOST_REQUIRE(huge);
+    BOOST_CHECK_EQUAL(1000u, huge->bytes());
+    BOOST_CHECK(!controller.try_admit("unknown"));
+    huge = Si::none;
+
+    Si::optional<ventura::memory_reservation> first = controller.try_admit("unknown");
+    BOOST_REQUIRE(first);
+    BOOST_CHECK(!controller.try_admit("unknown"));
+    controller.record("small", 40);
+    BOOST_CHECK(controller.try_admit("small"));
+}
+
+BOOST_AUTO_TEST_CASE(memory_admission_counts_reservations_against_available_memory)
+{
+    Si::optional<boost::uint64_t> const available = ventura::read_available_memory();
+    if (!available)
+    {
+        BOOST_TEST_MESSAGE("skipped: MemAvailable is unknown");
+        return;
+    }
+    ventura::memory_admission_options options((std::numeric_limits<boost::uint64_t>::max)() / 2u);
+    options.default_estimate_bytes = *available / 4u * 3u;
+    options.maximum_pressure = 100.0;
+    ventura::memory_admission_controller controller(options);
+    Si::optional<ventura::memory_reservation> const first = controller.try_admit("linker");
+    BOOST_REQUIRE(first);
+    // fits into the available memory alone, but not together with the first one that has not grown yet
+    BOOST_CHECK(!controller.try_admit("linker"));
+}
+
+BOOST_AUTO_TEST_CASE(memory_admission_records_peak)
+{
+    ventura::memory_admission_controller controller(ventura::memory_admission_options(1024u * 1024u * 1024u));
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/bin/true");
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    BOOST_CHECK_EQUAL(0, ventura::run_process(controller, "true", parameters).get());
+    BOOST_CHECK_GT(controller.predict("true"), 0u);
+    BOOST_CHECK_LT(controller.predict("true"), 1024u * 1024u * 1024u);
+}
+#endif
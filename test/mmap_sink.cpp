@@ -0,0 +1,62 @@
+#include <array>
+#include <boost/test/unit_test.hpp>
+#include <silicium/sink/append.hpp>
+#include <ventura/open.hpp>
+#include <ventura/sink/mmap_sink.hpp>
+#if SILICIUM_HAS_EXCEPTIONS
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#endif
+
+#if SILICIUM_HAS_EXCEPTIONS && VENTURA_HAS_MMAP_SINK
+namespace
+{
+    std::string read_whole_file(boost::filesystem::path const &name)
+    {
+        std::ifstream file(name.string(), std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(mmap_sink_random_writes)
+{
+    boost::filesystem::path const file_name = boost::filesystem::temp_directory_path() / "ventura_mmap_sink.txt";
+    {
+        Si::file_handle file = ventura::overwrite_file(Si::native_path_string(file_name.c_str())).move_value();
+        ventura::mmap_sink sink = ventura::mmap_sink::open(file.handle).move_value();
+        std::array<ventura::file_sink_element, 6> const elements{{ventura::seek_set{4}, Si::make_c_str_range("body"),
+                                                                  ventura::seek_set{0}, Si::make_c_str_range("head"),
+                                                                  ventura::seek_add{4}, ventura::flush{}}};
+        BOOST_REQUIRE_EQUAL(boost::system::error_code(),
+                            sink.append(Si::make_iterator_range(elements.data(), elements.data() + elements.size())));
+        BOOST_CHECK_EQUAL(8u, sink.cursor());
+        BOOST_CHECK_EQUAL(8u, sink.written_size());
+
+        // larger than the first growth step of the mapping
+        std::string const large(3 * ventura::mmap_sink::minimum_growth, 'x');
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_memory_range(large)}));
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{ventura::truncate_file{10}}));
+        BOOST_CHECK_EQUAL(10u, sink.written_size());
+        BOOST_REQUIRE_EQUAL(boost::system::error_code(), sink.finish());
+    }
+    BOOST_CHECK_EQUAL("headbodyxx", read_whole_file(file_name));
+}
+
+BOOST_AUTO_TEST_CASE(mmap_sink_keeps_existing_content)
+{
+    boost::filesystem::path const file_name =
+        boost::filesystem::temp_directory_path() / "ventura_mmap_sink_existing.txt";
+    {
+        std::ofstream existing(file_name.string(), std::ios::binary);
+        existing << "0123456789";
+    }
+    {
+        Si::file_handle file = ventura::open_read_write(Si::native_path_string(file_name.c_str())).move_value();
+        ventura::mmap_sink sink = ventura::mmap_sink::open(file.handle, true).move_value();
+        BOOST_CHECK_EQUAL(10u, sink.written_size());
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{ventura::seek_add{8}}));
+        BOOST_REQUIRE(!Si::append(sink, ventura::file_sink_element{Si::make_c_str_range("abcd")}));
+    }
+    BOOST_CHECK_EQUAL("01234567abcd", read_whole_file(file_name));
+}
+#endif
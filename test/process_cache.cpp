@@ -0,0 +1,90 @@
+#include <boost/test/unit_test.hpp>
+#include <silicium/sink/iterator_sink.hpp>
+#include <silicium/sink/virtualized_sink.hpp>
+#include <ventura/process_cache.hpp>
+
+#if VENTURA_HAS_PROCESS_CACHE && !defined(_WIN32)
+namespace
+{
+    ventura::absolute_path process_cache_test_root()
+    {
+        ventura::absolute_path const root =
+            ventura::get_current_working_directory(Si::throw_) / "process_cache_test";
+        ventura::recreate_directories(root, Si::throw_);
+        return root;
+    }
+
+    std::string read_text(ventura::absolute_path const &file)
+    {
+        std::vector<char> const content = ventura::read_file(file).move_value();
+        return std::string(content.begin(), content.end());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(process_cache_replays_standard_output)
+{
+    ventura::absolute_path const root = process_cache_test_root();
+    ventura::process_cache cache(root / "cache", 1024 * 1024);
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/usr/bin/which");
+    parameters.arguments.emplace_back("which");
+    parameters.current_path = root;
+    for (int i = 0; i < 2; ++i)
+    {
+        std::vector<char> out;
+        auto sink = Si::virtualize_sink(Si::make_iterator_sink<char>(std::back_inserter(out)));
+        parameters.out = &sink;
+        BOOST_CHECK_EQUAL(0, cache.run(parameters, {}, {}).get());
+        BOOST_CHECK_EQUAL("/usr/bin/which\n", std::string(out.begin(), out.end()));
+    }
+    ventura::process_cache_statistics const statistics = cache.statistics();
+    BOOST_CHECK_EQUAL(1u, statistics.misses);
+    BOOST_CHECK_EQUAL(1u, statistics.hits);
+    BOOST_CHECK_EQUAL(0u, statistics.store_failures);
+}
+
+BOOST_AUTO_TEST_CASE(process_cache_restores_outputs)
+{
+    ventura::absolute_path const root = process_cache_test_root();
+    ventura::absolute_path const input = root / "input.txt";
+    ventura::absolute_path const output = root / "output.txt";
+    Si::throw_if_error(ventura::write_file(safe_c_str(input), Si::make_c_str_range("first")));
+
+    ventura::process_cache cache(root / "cache", 1024 * 1024);
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/bin/cp");
+    parameters.arguments.emplace_back(to_os_string(input));
+    parameters.arguments.emplace_back(to_os_string(output));
+    parameters.current_path = root;
+    std::vector<ventura::absolute_path> const inputs{input};
+    std::vector<ventura::absolute_path> const outputs{output};
+
+    BOOST_REQUIRE_EQUAL(0, cache.run(parameters, inputs, outputs).get());
+    ventura::remove_file(output, Si::throw_);
+    BOOST_REQUIRE_EQUAL(0, cache.run(parameters, inputs, outputs).get());
+    BOOST_CHECK_EQUAL("first", read_text(output));
+    BOOST_CHECK_EQUAL(1u, cache.statistics().hits);
+
+    // a changed input is a different action
+    Si::throw_if_error(ventura::write_file(safe_c_str(input), Si::make_c_str_range("second")));
+    BOOST_REQUIRE_EQUAL(0, cache.run(parameters, inputs, outputs).get());
+    BOOST_CHECK_EQUAL("second", read_text(output));
+    BOOST_CHECK_EQUAL(2u, cache.statistics().misses);
+}
+
+BOOST_AUTO_TEST_CASE(process_cache_evicts_by_size)
+{
+    ventura::absolute_path const root = process_cache_test_root();
+    ventura::process_cache cache(root / "cache", 0);
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/usr/bin/which");
+    parameters.arguments.emplace_back("which");
+    parameters.current_path = root;
+    BOOST_CHECK_EQUAL(0, cache.run(parameters, {}, {}).get());
+    BOOST_CHECK_EQUAL(0, cache.run(parameters, {}, {}).get());
+    ventura::process_cache_statistics const statistics = cache.statistics();
+    BOOST_CHECK_EQUAL(2u, statistics.misses);
+    BOOST_CHECK_EQUAL(0u, statistics.hits);
+    BOOST_CHECK_EQUAL(2u, statistics.evicted_entries);
+}
+#endif
@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+#include <ventura/file_operations.hpp>
+#include <ventura/process_graph.hpp>
+
+#if VENTURA_HAS_PROCESS_GRAPH && !defined(_WIN32)
+namespace
+{
+    ventura::process_parameters make_command(char const *executable)
+    {
+        ventura::process_parameters parameters;
+        parameters.executable = *ventura::absolute_path::create(executable);
+        parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+        return parameters;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(process_graph_cancels_dependents_of_failure)
+{
+    ventura::process_graph graph;
+    ventura::process_node_id const ok = graph.add("ok", make_command("/bin/true"));
+    ventura::process_node_id const fails = graph.add("fails", make_command("/bin/false"));
+    ventura::process_node_id const join = graph.add("join", make_command("/bin/true"));
+    ventura::process_node_id const after_join = graph.add("after_join", make_command("/bin/true"));
+    ventura::process_node_id const independent = graph.add("independent", make_command("/bin/true"));
+    graph.depend(join, ok);
+    graph.depend(join, fails);
+    graph.depend(after_join, join);
+    graph.depend(independent, ok);
+
+    ventura::process_duration_history history;
+    std::vector<ventura::process_node_result> const results = ventura::run_process_graph(graph, 2, history);
+    BOOST_REQUIRE_EQUAL(5u, results.size());
+    BOOST_CHECK(results[ok].state == ventura::process_node_state::succeeded);
+    BOOST_CHECK(results[fails].state == ventura::process_node_state::failed);
+    BOOST_CHECK_EQUAL(1, results[fails].exit_code);
+    BOOST_CHECK(results[join].state == ventura::process_node_state::cancelled);
+    BOOST_CHECK(results[after_join].state == ventura::process_node_state::cancelled);
+    BOOST_CHECK(results[independent].state == ventura::process_node_state::succeeded);
+    BOOST_CHECK_EQUAL(1u, history.count("ok"));
+    BOOST_CHECK_EQUAL(1u, history.count("independent"));
+    BOOST_CHECK_EQUAL(0u, history.count("fails"));
+}
+
+BOOST_AUTO_TEST_CASE(process_graph_estimates_critical_paths)
+{
+    ventura::process_graph graph;
+    ventura::process_node_id const compile = graph.add("compile", make_command("/bin/true"));
+    ventura::process_node_id const link = graph.add("link", make_command("/bin/true"));
+    ventura::process_node_id const lint = graph.add("lint", make_command("/bin/true"));
+    ventura::process_node_id const unknown = graph.add("unknown", make_command("/bin/true"));
+    graph.depend(link, compile);
+
+    ventura::process_duration_history history;
+    history["compile"] = std::chrono::milliseconds(100);
+    history["link"] = std::chrono::milliseconds(50);
+    history["lint"] = std::chrono::milliseconds(10);
+    std::vector<std::chrono::milliseconds> const priorities =
+        ventura::detail::estimate_critical_paths(graph, history);
+    BOOST_REQUIRE_EQUAL(4u, priorities.size());
+    BOOST_CHECK_EQUAL(150, priorities[compile].count());
+    BOOST_CHECK_EQUAL(50, priorities[link].count());
+    BOOST_CHECK_EQUAL(10, priorities[lint].count());
+    // commands without history are estimated with the average of the known ones
+    BOOST_CHECK_EQUAL(160 / 3, priorities[unknown].count());
+}
+
+BOOST_AUTO_TEST_CASE(process_graph_starts_longest_path_first)
+{
+    ventura::absolute_path const order_file =
+        ventura::get_current_working_directory(Si::throw_) / "process_graph_order.txt";
+    ventura::remove_file(order_file, Si::throw_);
+    auto const make_recording = [&order_file](char const *name)
+    {
+        ventura::process_parameters parameters = make_command("/bin/sh");
+        parameters.arguments.emplace_back("-c");
+        parameters.arguments.emplace_back(std::string("echo ") + name + " >> " + order_file.c_str());
+        return parameters;
+    };
+    ventura::process_graph graph;
+    graph.add("short", make_recording("short"));
+    ventura::process_node_id const before_long = graph.add("before_long", make_recording("before_long"));
+    ventura::process_node_id const long_tail = graph.add("long_tail", make_recording("long_tail"));
+    graph.add("medium", make_recording("medium"));
+    graph.depend(long_tail, before_long);
+
+    ventura::process_duration_history history;
+    history["short"] = std::chrono::milliseconds(10);
+    history["before_long"] = std::chrono::milliseconds(20);
+    history["long_tail"] = std::chrono::milliseconds(300);
+    history["medium"] = std::chrono::milliseconds(100);
+    std::vector<ventura::process_node_result> const results = ventura::run_process_graph(graph, 1, history);
+    for (ventura::process_node_result const &result : results)
+    {
+        BOOST_CHECK(result.state == ventura::process_node_state::succeeded);
+    }
+    std::vector<char> const order = ventura::read_file(order_file).move_value();
+    BOOST_CHECK_EQUAL("before_long\nlong_tail\nmedium\nshort\n", std::string(order.begin(), order.end()));
+}
+
+BOOST_AUTO_TEST_CASE(process_graph_rejects_cycles)
+{
+    ventura::process_graph graph;
+    ventura::process_node_id const first = graph.add("first", make_command("/bin/true"));
+    ventura::process_node_id const second = graph.add("second", make_command("/bin/true"));
+    graph.depend(first, second);
+    graph.depend(second, first);
+    ventura::process_duration_history history;
+    BOOST_CHECK_THROW(ventura::run_process_graph(graph, 1, history), std::invalid_argument);
+}
+#endif
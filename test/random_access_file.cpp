@@ -0,0 +1,84 @@
+#include <boost/test/unit_test.hpp>
+#include <ventura/random_access_file.hpp>
+#if VENTURA_HAS_RANDOM_ACCESS_FILE && SILICIUM_HAS_EXCEPTIONS
+#include <boost/filesystem/operations.hpp>
+#include <array>
+#include <thread>
+#endif
+
+#if VENTURA_HAS_RANDOM_ACCESS_FILE && SILICIUM_HAS_EXCEPTIONS
+namespace
+{
+    ventura::random_access_file open_empty_file(char const *name, boost::uint64_t growth_step)
+    {
+        boost::filesystem::path const file_name = boost::filesystem::temp_directory_path() / name;
+        boost::filesystem::remove(file_name);
+        return ventura::random_access_file::open(Si::native_path_string(file_name.c_str()), growth_step).move_value();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(random_access_file_read_write_at)
+{
+    ventura::random_access_file file = open_empty_file("ventura_random_access_file_read_write_at", 1024 * 1024);
+    BOOST_CHECK_EQUAL(0u, file.size());
+    BOOST_REQUIRE(!file.write_at(4, Si::make_c_str_range("5678")));
+    BOOST_CHECK_EQUAL(8u, file.size());
+    BOOST_REQUIRE(!file.write_at(0, Si::make_c_str_range("1234")));
+    BOOST_CHECK_EQUAL(8u, file.size());
+
+    std::array<char, 3> first;
+    std::array<char, 10> second;
+    std::array<iovec, 2> buffers = {{{first.data(), first.size()}, {second.data(), second.size()}}};
+    BOOST_CHECK_EQUAL(7u, file.read_vector_at(1, buffers.data(), buffers.size()).get());
+    BOOST_CHECK_EQUAL("234", std::string(first.begin(), first.end()));
+    BOOST_CHECK_EQUAL("5678", std::string(second.begin(), second.begin() + 4));
+
+    std::array<char, 4> at_end;
+    BOOST_CHECK_EQUAL(0u, file.read_at(8, Si::make_contiguous_range(at_end)).get());
+
+    BOOST_REQUIRE(!file.resize(2));
+    BOOST_CHECK_EQUAL(2u, file.size());
+    BOOST_REQUIRE(!file.refresh_size());
+    BOOST_CHECK_EQUAL(2u, file.size());
+}
+
+BOOST_AUTO_TEST_CASE(random_access_file_parallel_shards)
+{
+    ventura::random_access_file file = open_empty_file("ventura_random_access_file_parallel_shards", 0);
+    std::size_t const shard_count = 4;
+    std::size_t const writes_per_shard = 1000;
+    std::vector<ventura::random_access_file_shard> shards =
+        file.make_shards(0, shard_count * writes_per_shard * 2, shard_count);
+    BOOST_REQUIRE_EQUAL(shard_count, shards.size());
+    std::vector<boost::system::error_code> errors(shard_count);
+    std::vector<std::thread> writers;
+    for (std::size_t i = 0; i < shard_count; ++i)
+    {
+        writers.emplace_back([&shards, &errors, i, writes_per_shard]()
+                             {
+                                 char const piece[2] = {static_cast<char>('a' + i), '\n'};
+                                 for (std::size_t k = 0; (k < writes_per_shard) && !errors[i]; ++k)
+                                 {
+                                     errors[i] = shards[i].write(Si::make_memory_range(piece, 2));
+                                 }
+                             });
+    }
+    for (std::thread &writer : writers)
+    {
+        writer.join();
+    }
+    for (boost::system::error_code const &error : errors)
+    {
+        BOOST_CHECK_EQUAL(boost::system::error_code(), error);
+    }
+    BOOST_CHECK(shards[0].write(Si::make_c_str_range("x")) == boost::system::errc::file_too_large);
+    BOOST_CHECK_EQUAL(shard_count * writes_per_shard * 2, file.size());
+
+    std::vector<char> content(static_cast<std::size_t>(file.size()));
+    BOOST_REQUIRE_EQUAL(content.size(), file.read_at(0, Si::make_contiguous_range(content)).get());
+    for (std::size_t i = 0; i < content.size(); i += 2)
+    {
+        BOOST_REQUIRE_EQUAL(static_cast<char>('a' + (i / (writes_per_shard * 2))), content[i]);
+    }
+}
+#endif
@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
+#include <silicium/pipe.hpp>
+#include <silicium/write.hpp>
 #include <ventura/file_operations.hpp>
 #include <ventura/read_file.hpp>
 #include <ventura/write_file.hpp>
@@ -39,4 +42,97 @@ BOOST_AUTO_TEST_CASE(read_file)
     BOOST_CHECK_EQUAL_COLLECTIONS(expected_content.begin(), expected_content.end(), read.begin(), read.end());
 }
 
+BOOST_AUTO_TEST_CASE(read_file_maximum_size)
+{
+    Si::os_string const file = to_os_string(test_root() / "read_file_maximum_size.txt");
+    Si::native_path_string const file_name(file.c_str());
+    Si::throw_if_error(ventura::write_file(file_name, Si::make_c_str_range("Hello")));
+    auto const result = ventura::read_file(file_name, 4);
+    ventura::read_file_problem const *const problem = Si::try_get_ptr<ventura::read_file_problem>(result);
+    BOOST_REQUIRE(problem);
+    BOOST_CHECK(*problem == ventura::read_file_problem::maximum_size_exceeded);
+    BOOST_CHECK(Si::try_get_ptr<std::vector<char>>(ventura::read_file(file_name, 5)));
+}
+
+#ifdef __linux__
+BOOST_AUTO_TEST_CASE(read_file_procfs)
+{
+    // files in /proc report a size of zero
+    auto const result = ventura::read_file(Si::native_path_string("/proc/self/status"));
+    std::vector<char> const *const content = Si::try_get_ptr<std::vector<char>>(result);
+    BOOST_REQUIRE(content);
+    std::string const prefix = "Name:";
+    BOOST_REQUIRE_GE(content->size(), prefix.size());
+    BOOST_CHECK(std::equal(prefix.begin(), prefix.end(), content->begin()));
+
+    auto const limited = ventura::read_file(Si::native_path_string("/proc/self/status"), 10);
+    ventura::read_file_problem const *const problem = Si::try_get_ptr<ventura::read_file_problem>(limited);
+    BOOST_REQUIRE(problem);
+    BOOST_CHECK(*problem == ventura::read_file_problem::maximum_size_exceeded);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(read_file_large)
+{
+    Si::os_string const file = to_os_string(test_root() / "read_file_large.txt");
+    Si::native_path_string const file_name(file.c_str());
+    std::string expected(3 * 1024 * 1024 + 1, '\0');
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        expected[i] = static_cast<char>('a' + (i % 26));
+    }
+    Si::throw_if_error(ventura::write_file(file_name, Si::make_memory_range(expected)));
+    auto const result = ventura::read_file(file_name);
+    std::vector<char> const *const content = Si::try_get_ptr<std::vector<char>>(result);
+    BOOST_REQUIRE(content);
+    BOOST_CHECK(std::equal(expected.begin(), expected.end(), content->begin()));
+    BOOST_CHECK_EQUAL(expected.size(), content->size());
+}
+
+BOOST_AUTO_TEST_CASE(read_file_from_cursor)
+{
+    Si::os_string const file = to_os_string(test_root() / "read_file_from_cursor.txt");
+    Si::native_path_string const file_name(file.c_str());
+    Si::throw_if_error(ventura::write_file(file_name, Si::make_c_str_range("0123456789")));
+    Si::file_handle const opened = ventura::open_reading(file_name).move_value();
+    Si::throw_if_error(ventura::seek_absolute(opened.handle, 4));
+    // ending earlier than the size suggests is not mistaken for a concurrent modification
+    std::vector<char> const content = ventura::read_file(opened.handle).move_value();
+    std::string const expected = "456789";
+    BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), content.begin(), content.end());
+}
+
+BOOST_AUTO_TEST_CASE(read_file_into_reuses_storage)
+{
+    Si::os_string const file = to_os_string(test_root() / "read_file_into.txt");
+    Si::native_path_string const file_name(file.c_str());
+    Si::throw_if_error(ventura::write_file(file_name, Si::make_c_str_range("configuration")));
+    std::vector<char> content;
+    content.reserve(100);
+    char const *const storage = content.data();
+    for (int i = 0; i < 3; ++i)
+    {
+        auto const result = ventura::read_file_into(file_name, content);
+        std::size_t const *const size = Si::try_get_ptr<std::size_t>(result);
+        BOOST_REQUIRE(size);
+        BOOST_CHECK_EQUAL(13u, *size);
+        BOOST_CHECK_EQUAL("configuration", std::string(content.begin(), content.end()));
+        BOOST_CHECK_EQUAL(static_cast<void const *>(storage), static_cast<void const *>(content.data()));
+    }
+
+    std::string text = "previous content that is longer";
+    BOOST_REQUIRE(Si::try_get_ptr<std::size_t>(ventura::read_file_into(file_name, text)));
+    BOOST_CHECK_EQUAL("configuration", text);
+}
+
+BOOST_AUTO_TEST_CASE(read_file_pipe)
+{
+    Si::pipe buffer = Si::make_pipe().move_value();
+    std::string const expected(1000, 'p');
+    BOOST_REQUIRE_EQUAL(expected.size(), Si::write(buffer.write.handle, Si::make_memory_range(expected)).get());
+    buffer.write.close();
+    std::vector<char> const content = ventura::read_file(buffer.read.handle).move_value();
+    BOOST_CHECK_EQUAL_COLLECTIONS(expected.begin(), expected.end(), content.begin(), content.end());
+}
+
 #endif
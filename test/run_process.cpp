@@ -7,6 +7,14 @@
 #include <ventura/run_process.hpp>
 #if VENTURA_HAS_RUN_PROCESS
 #include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
+#include <future>
+#include <thread>
+#endif
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
 #endif
 
 #if VENTURA_HAS_RUN_PROCESS
@@ -25,6 +33,108 @@ BOOST_AUTO_TEST_CASE(run_process_1_unix_which)
     std::string const expected = "/usr/bin/which\n";
     BOOST_CHECK_EQUAL(expected, std::string(begin(out), end(out)));
 }
+
+BOOST_AUTO_TEST_CASE(run_process_scheduling)
+{
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/bin/sh");
+    parameters.arguments.emplace_back("-c");
+    parameters.arguments.emplace_back("ulimit -n; nice");
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    parameters.scheduling.nice = 19;
+    ventura::resource_limit const open_files = {ventura::resource_limit_type::open_files, 64, 64};
+    parameters.scheduling.limits.emplace_back(open_files);
+    std::vector<char> out;
+    auto sink = Si::virtualize_sink(Si::make_iterator_sink<char>(std::back_inserter(out)));
+    parameters.out = &sink;
+    BOOST_CHECK_EQUAL(0, ventura::run_process(parameters).get());
+    BOOST_CHECK_EQUAL("64\n19\n", std::string(begin(out), end(out)));
+}
+
+BOOST_AUTO_TEST_CASE(run_process_many_arguments)
+{
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/bin/sh");
+    parameters.arguments.emplace_back("-c");
+    parameters.arguments.emplace_back("printf '%s|' \"$#\" \"$1\" \"${1000}\"");
+    parameters.arguments.emplace_back("sh");
+    parameters.arguments.emplace_back("");
+    for (int i = 2; i <= 1000; ++i)
+    {
+        parameters.arguments.emplace_back(boost::lexical_cast<Si::os_string>(i));
+    }
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    std::vector<char> out;
+    auto sink = Si::virtualize_sink(Si::make_iterator_sink<char>(std::back_inserter(out)));
+    parameters.out = &sink;
+    BOOST_REQUIRE_EQUAL(0, ventura::run_process(parameters).get());
+    BOOST_CHECK_EQUAL("1000||1000|", std::string(begin(out), end(out)));
+}
+
+BOOST_AUTO_TEST_CASE(run_process_deadline)
+{
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/bin/sh");
+    parameters.arguments.emplace_back("-c");
+    parameters.arguments.emplace_back("echo started; trap '' TERM; sleep 30");
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    std::vector<char> out;
+    auto sink = Si::virtualize_sink(Si::make_iterator_sink<char>(std::back_inserter(out)));
+    parameters.out = &sink;
+    auto const started = std::chrono::steady_clock::now();
+    parameters.deadline = started + std::chrono::milliseconds(200);
+    parameters.kill_grace_period = std::chrono::milliseconds(200);
+    Si::error_or<int> const result = ventura::run_process(parameters);
+    BOOST_REQUIRE(result.is_error());
+    BOOST_CHECK(result.error() == boost::system::errc::timed_out);
+    BOOST_CHECK_EQUAL("started\n", std::string(begin(out), end(out)));
+    BOOST_CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(10));
+}
+
+BOOST_AUTO_TEST_CASE(process_watchdog_ignores_exited_child)
+{
+    // the deadline passes after the child has exited, but before the watchdog is stopped
+    pid_t const child = fork();
+    BOOST_REQUIRE(child >= 0);
+    if (child == 0)
+    {
+        _exit(3);
+    }
+    ventura::detail::wait_without_reaping(child);
+    {
+        ventura::detail::process_watchdog watchdog(child, std::chrono::steady_clock::now(),
+                                                   std::chrono::milliseconds(100), nullptr);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        watchdog.stop();
+        BOOST_CHECK(watchdog.verdict() == ventura::detail::watchdog_verdict::none);
+    }
+    int status = 0;
+    BOOST_REQUIRE_EQUAL(child, waitpid(child, &status, 0));
+    BOOST_REQUIRE(WIFEXITED(status));
+    BOOST_CHECK_EQUAL(3, WEXITSTATUS(status));
+}
+
+BOOST_AUTO_TEST_CASE(run_process_cancellation)
+{
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create("/bin/sh");
+    parameters.arguments.emplace_back("-c");
+    parameters.arguments.emplace_back("sleep 30");
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    ventura::process_cancellation cancellation;
+    parameters.cancellation = &cancellation;
+    auto const started = std::chrono::steady_clock::now();
+    auto canceller = std::async(std::launch::async, [&cancellation]()
+                                {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                                    cancellation.cancel();
+                                });
+    Si::error_or<int> const result = ventura::run_process(parameters);
+    canceller.get();
+    BOOST_REQUIRE(result.is_error());
+    BOOST_CHECK(result.error() == boost::system::errc::operation_canceled);
+    BOOST_CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(10));
+}
 #endif
 
 #ifdef _WIN32
@@ -113,6 +223,25 @@ BOOST_AUTO_TEST_CASE(run_process_standard_input_line_feed)
     BOOST_CHECK_EQUAL_COLLECTIONS(message.begin(), message.end(), output_buffer.begin(), output_buffer.end());
 }
 
+BOOST_AUTO_TEST_CASE(run_process_static_sinks)
+{
+    ventura::process_parameters parameters;
+    parameters.executable = *ventura::absolute_path::create(VENTURA_TEST_CAT);
+    parameters.current_path = ventura::get_current_working_directory(Si::throw_);
+    std::string message;
+    std::generate_n(std::back_inserter(message), 100000, []()
+                    {
+                        return 'a';
+                    });
+    std::vector<char> output_buffer;
+    std::vector<char> error_buffer;
+    BOOST_CHECK_EQUAL(0, ventura::run_process(parameters, Si::make_container_sink(output_buffer),
+                                              Si::make_container_sink(error_buffer),
+                                              Si::make_range_source(Si::make_contiguous_range(message))));
+    BOOST_CHECK_EQUAL_COLLECTIONS(message.begin(), message.end(), output_buffer.begin(), output_buffer.end());
+    BOOST_CHECK(error_buffer.empty());
+}
+
 BOOST_AUTO_TEST_CASE(run_process_standard_input_large)
 {
     ventura::process_parameters parameters;
@@ -0,0 +1,182 @@
+#ifndef VENTURA_ACCESS_PATTERN_HPP
+#define VENTURA_ACCESS_PATTERN_HPP
+
+#include <silicium/file_handle.hpp>
+#include <silicium/optional.hpp>
+#include <boost/cstdint.hpp>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if !defined(_WIN32) && defined(POSIX_FADV_SEQUENTIAL)
+#define VENTURA_HAS_ACCESS_HINTS 1
+#else
+#define VENTURA_HAS_ACCESS_HINTS 0
+#endif
+
+namespace ventura
+{
+    /// Tells the operating system how a file is going to be used so that the page cache can be managed accordingly.
+    /// These are only hints. They are ignored where the system has no way to express them.
+    enum class access_pattern
+    {
+        /// the default behaviour of the system
+        normal,
+
+        /// The file is read from the beginning to the end. The readahead window is larger and data is requested ahead
+        /// of the reader.
+        sequential,
+
+        /// Like sequential, but the data is used only once, so it is dropped from the page cache after it has been
+        /// read or written. A large job then does not push everything else out of memory.
+        streaming
+    };
+
+    namespace detail
+    {
+        /// how far a sequential reader requests data ahead of itself
+        boost::uint64_t const readahead_window = 1024 * 1024;
+
+        /// how much a streaming writer writes before it starts the writeback of these pages
+        boost::uint64_t const write_behind_window = 8 * 1024 * 1024;
+
+#if VENTURA_HAS_ACCESS_HINTS
+        inline void advise(Si::native_file_descriptor file, boost::uint64_t offset, boost::uint64_t length, int advice)
+        {
+            // the result is ignored because this is only a hint
+#ifdef __linux__
+            (void)posix_fadvise64(file, static_cast<off64_t>(offset), static_cast<off64_t>(length), advice);
+#else
+            (void)posix_fadvise(file, static_cast<off_t>(offset), static_cast<off_t>(length), advice);
+#endif
+        }
+
+        /// the position of the cursor of the file, none for pipes and other files that cannot seek
+        inline Si::optional<boost::uint64_t> current_offset(Si::native_file_descriptor file)
+        {
+#ifdef __linux__
+            off64_t const position = lseek64(file, 0, SEEK_CUR);
+#else
+            off_t const position = lseek(file, 0, SEEK_CUR);
+#endif
+            if (position < 0)
+            {
+                return Si::none;
+            }
+            return static_cast<boost::uint64_t>(position);
+        }
+
+        inline void advise_pattern(Si::native_file_descriptor file, access_pattern pattern)
+        {
+            advise(file, 0, 0, (pattern == access_pattern::normal) ? POSIX_FADV_NORMAL : POSIX_FADV_SEQUENTIAL);
+        }
+
+        /// Starts the writeback of the range that has just been written and drops the range before it from the page
+        /// cache. Waiting only for the previous range keeps the device busy without blocking the writer for long. The
+        /// range spans from the lowest to the highest offset written since the last start, which includes any gaps
+        /// between the writes when the position jumps.
+        struct write_behind
+        {
+            write_behind() BOOST_NOEXCEPT : m_unsynced(0),
+                                            m_run(0),
+                                            m_lowest(0),
+                                            m_highest(0),
+                                            m_previous_begin(0),
+                                            m_previous_end(0)
+            {
+            }
+
+            /// @return whether enough has been written since the last call of start to call it again
+            bool written(std::size_t bytes) BOOST_NOEXCEPT
+            {
+                m_unsynced += bytes;
+                m_run += bytes;
+                return m_unsynced >= write_behind_window;
+            }
+
+            /// whether jumping has to be called before the position changes
+            bool is_in_run() const BOOST_NOEXCEPT
+            {
+                return m_run > 0;
+            }
+
+            /// Has to be called before the position of the file changes other than by writing. The writes since the
+            /// last jump are contiguous, so their range is known from the position where they ended.
+            /// @param position the position of the file after the last write
+            void jumping(boost::uint64_t position) BOOST_NOEXCEPT
+            {
+                end_run(position);
+            }
+
+            /// @param end the position of the file after the last write
+            void start(Si::native_file_descriptor file, boost::uint64_t end) BOOST_NOEXCEPT
+            {
+                end_run(end);
+                boost::uint64_t const begin = m_lowest;
+                end = m_highest;
+                m_unsynced = 0;
+                m_lowest = 0;
+                m_highest = 0;
+#ifdef __linux__
+                // a length of zero would mean everything up to the end of the file
+                if (end > begin)
+                {
+                    (void)sync_file_range(file, static_cast<off64_t>(begin), static_cast<off64_t>(end - begin),
+                                          SYNC_FILE_RANGE_WRITE);
+                }
+                if (m_previous_end > m_previous_begin)
+                {
+                    (void)sync_file_range(file, static_cast<off64_t>(m_previous_begin),
+                                          static_cast<off64_t>(m_previous_end - m_previous_begin),
+                                          SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                                              SYNC_FILE_RANGE_WAIT_AFTER);
+                }
+#endif
+                // without sync_file_range only the pages that have been written back in the meantime are dropped
+                if (m_previous_end > m_previous_begin)
+                {
+                    advise(file, m_previous_begin, m_previous_end - m_previous_begin, POSIX_FADV_DONTNEED);
+                }
+                m_previous_begin = begin;
+                m_previous_end = end;
+            }
+
+        private:
+            boost::uint64_t m_unsynced;
+
+            /// the bytes written since the last jump, which end at the current position
+            boost::uint64_t m_run;
+
+            /// the range written since the last start, empty if m_lowest == m_highest
+            boost::uint64_t m_lowest;
+            boost::uint64_t m_highest;
+
+            boost::uint64_t m_previous_begin;
+            boost::uint64_t m_previous_end;
+
+            void end_run(boost::uint64_t position) BOOST_NOEXCEPT
+            {
+                if (m_run == 0)
+                {
+                    return;
+                }
+                boost::uint64_t const begin = (position >= m_run) ? (position - m_run) : 0;
+                m_run = 0;
+                if (m_lowest == m_highest)
+                {
+                    m_lowest = begin;
+                    m_highest = position;
+                    return;
+                }
+                m_lowest = (std::min)(m_lowest, begin);
+                m_highest = (std::max)(m_highest, position);
+            }
+        };
+#endif
+    }
+}
+
+#endif
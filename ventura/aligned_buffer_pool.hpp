@@ -0,0 +1,166 @@
+#ifndef VENTURA_ALIGNED_BUFFER_POOL_HPP
+#define VENTURA_ALIGNED_BUFFER_POOL_HPP
+
+#include <ventura/detail/aligned_buffer.hpp>
+#include <silicium/config.hpp>
+#include <silicium/iterator_range.hpp>
+#include <cassert>
+#include <mutex>
+#include <vector>
+
+namespace ventura
+{
+    struct aligned_buffer_pool;
+
+    /// A buffer borrowed from an aligned_buffer_pool. The destructor gives it back.
+    struct pooled_buffer
+    {
+        pooled_buffer() BOOST_NOEXCEPT : m_pool(nullptr), m_size(0)
+        {
+        }
+
+        pooled_buffer(aligned_buffer_pool &pool, detail::aligned_buffer memory, std::size_t size) BOOST_NOEXCEPT
+            : m_pool(&pool),
+              m_memory(std::move(memory)),
+              m_size(size)
+        {
+        }
+
+        pooled_buffer(pooled_buffer &&other) BOOST_NOEXCEPT : m_pool(other.m_pool),
+                                                              m_memory(std::move(other.m_memory)),
+                                                              m_size(other.m_size)
+        {
+            other.m_pool = nullptr;
+            other.m_size = 0;
+        }
+
+        pooled_buffer &operator=(pooled_buffer &&other) BOOST_NOEXCEPT
+        {
+            if (this != &other)
+            {
+                release();
+                m_pool = other.m_pool;
+                m_memory = std::move(other.m_memory);
+                m_size = other.m_size;
+                other.m_pool = nullptr;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+
+        ~pooled_buffer() BOOST_NOEXCEPT
+        {
+            release();
+        }
+
+        char *data() const BOOST_NOEXCEPT
+        {
+            return m_memory.get();
+        }
+
+        std::size_t size() const BOOST_NOEXCEPT
+        {
+            return m_size;
+        }
+
+        Si::iterator_range<char *> range() const BOOST_NOEXCEPT
+        {
+            return Si::make_iterator_range(data(), data() + size());
+        }
+
+        inline void release() BOOST_NOEXCEPT;
+
+    private:
+        aligned_buffer_pool *m_pool;
+        detail::aligned_buffer m_memory;
+        std::size_t m_size;
+
+        SILICIUM_DELETED_FUNCTION(pooled_buffer(pooled_buffer const &))
+        SILICIUM_DELETED_FUNCTION(pooled_buffer &operator=(pooled_buffer const &))
+    };
+
+    /// Recycles buffers of one size and alignment, for example for direct I/O where every buffer has to be aligned
+    /// to the logical block size. The pool has to outlive the buffers it lends.
+    struct aligned_buffer_pool
+    {
+        /// @param buffer_size a multiple of the alignment
+        /// @param alignment a power of two that is at least sizeof(void *)
+        explicit aligned_buffer_pool(std::size_t buffer_size, std::size_t alignment = 4096)
+            : m_buffer_size(buffer_size)
+            , m_alignment(alignment)
+        {
+            assert(alignment > 0);
+            assert((buffer_size % alignment) == 0);
+        }
+
+        SILICIUM_USE_RESULT
+        pooled_buffer acquire()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_free.empty())
+                {
+                    detail::aligned_buffer recycled = std::move(m_free.back());
+                    m_free.pop_back();
+                    return pooled_buffer(*this, std::move(recycled), m_buffer_size);
+                }
+            }
+            return pooled_buffer(*this, detail::allocate_aligned(m_buffer_size, m_alignment), m_buffer_size);
+        }
+
+        std::size_t buffer_size() const BOOST_NOEXCEPT
+        {
+            return m_buffer_size;
+        }
+
+        std::size_t alignment() const BOOST_NOEXCEPT
+        {
+            return m_alignment;
+        }
+
+        /// the number of buffers that wait to be reused
+        std::size_t idle_buffers() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_free.size();
+        }
+
+    private:
+        friend struct pooled_buffer;
+
+        std::size_t m_buffer_size;
+        std::size_t m_alignment;
+        mutable std::mutex m_mutex;
+        std::vector<detail::aligned_buffer> m_free;
+
+        void give_back(detail::aligned_buffer memory) BOOST_NOEXCEPT
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            try
+            {
+                m_free.emplace_back(std::move(memory));
+            }
+            catch (...)
+            {
+                // the buffer is freed instead of being recycled
+            }
+        }
+
+        SILICIUM_DELETED_FUNCTION(aligned_buffer_pool(aligned_buffer_pool const &))
+        SILICIUM_DELETED_FUNCTION(aligned_buffer_pool &operator=(aligned_buffer_pool const &))
+    };
+
+    inline void pooled_buffer::release() BOOST_NOEXCEPT
+    {
+        if (!m_pool)
+        {
+            return;
+        }
+        aligned_buffer_pool *const pool = m_pool;
+        m_pool = nullptr;
+        m_size = 0;
+        pool->give_back(std::move(m_memory));
+    }
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define VENTURA_ASYNC_PROCESS_HPP
 
 #include <boost/thread/thread.hpp>
+#include <silicium/iterator_range.hpp>
 #include <silicium/os_string.hpp>
 #include <silicium/pipe.hpp>
 #include <silicium/sink/append.hpp>
@@ -9,6 +10,8 @@
 #include <ventura/absolute_path.hpp>
 #include <ventura/process_parameters.hpp>
 #include <ventura/process_handle.hpp>
+#include <ventura/process_scheduling.hpp>
+#include <algorithm>
 
 #if SILICIUM_HAS_EXCEPTIONS
 #include <boost/filesystem/operations.hpp>
@@ -22,6 +25,16 @@
 #endif
 #endif
 
+#if !defined(_WIN32) && (defined(__linux__) || defined(__FreeBSD__))
+#define VENTURA_HAS_FEXECVE 1
+#else
+#define VENTURA_HAS_FEXECVE 0
+#endif
+
+#if VENTURA_HAS_FEXECVE
+extern char **environ;
+#endif
+
 // TODO: avoid the Boost filesystem operations that require exceptions
 #define VENTURA_HAS_LAUNCH_PROCESS SILICIUM_HAS_EXCEPTIONS
 
@@ -29,6 +42,14 @@ namespace ventura
 {
     struct async_process_parameters
     {
+#ifndef _WIN32
+        async_process_parameters()
+            : executable_file(-1)
+            , own_process_group(false)
+        {
+        }
+#endif
+
         absolute_path executable;
 
         /// the values for the child's argv[1...]
@@ -36,6 +57,23 @@ namespace ventura
 
         /// must be an existing path, otherwise the child cannot launch properly
         absolute_path current_path;
+
+#ifndef _WIN32
+        /// An open descriptor of the executable (see executable_handle) or -1. Where fexecve is available, the child
+        /// executes this file instead of resolving the path again. The path is still used for scripts and as argv[0].
+        Si::native_file_descriptor executable_file;
+
+        /// these file descriptors stay open in the child under the same numbers, everything else above stderr is
+        /// closed
+        std::vector<Si::native_file_descriptor> inherited_file_descriptors;
+
+        /// CPU affinity, priorities and resource limits of the child
+        process_scheduling scheduling;
+
+        /// makes the child the leader of a new process group so that it can be signalled together with its
+        /// descendants
+        bool own_process_group;
+#endif
     };
 
     struct async_process
@@ -94,6 +132,29 @@ namespace ventura
         Si::error_or<int> wait_for_exit() BOOST_NOEXCEPT
         {
 #ifndef _WIN32
+            boost::system::error_code const launch_error = wait_for_launch();
+            if (!!launch_error)
+            {
+                return launch_error;
+            }
+#endif
+            return process.wait_for_exit();
+        }
+
+#ifndef _WIN32
+        Si::error_or<int> wait_for_exit(process_resource_usage &usage) BOOST_NOEXCEPT
+        {
+            boost::system::error_code const launch_error = wait_for_launch();
+            if (!!launch_error)
+            {
+                return launch_error;
+            }
+            return process.wait_for_exit(usage);
+        }
+
+        /// Blocks until the child has called exec. Returns the error that prevented exec, if any.
+        boost::system::error_code wait_for_launch() BOOST_NOEXCEPT
+        {
             int error = 0;
             ssize_t read_error = read(child_error.handle, &error, sizeof(error));
             if (read_error < 0)
@@ -105,26 +166,41 @@ namespace ventura
                 assert(read_error == sizeof(error));
                 return boost::system::error_code(error, boost::system::system_category());
             }
-#endif
-            return process.wait_for_exit();
+            return boost::system::error_code();
         }
+#endif
     };
 
 #if VENTURA_HAS_LAUNCH_PROCESS
+    namespace detail
+    {
+        inline Si::iterator_range<Si::os_string const *> all_arguments(async_process_parameters const &parameters)
+        {
+            return Si::make_iterator_range(parameters.arguments.data(),
+                                           parameters.arguments.data() + parameters.arguments.size());
+        }
+    }
 
 #ifdef _WIN32
     namespace detail
     {
-        inline Si::os_string build_command_line(std::vector<Si::os_string> const &arguments)
+        inline Si::os_string build_command_line(Si::os_string const &executable,
+                                                Si::iterator_range<Si::os_string const *> arguments)
         {
+            std::size_t length = executable.size() + 2;
+            for (Si::os_string const &argument : arguments)
+            {
+                length += 1 + argument.size();
+            }
             Si::os_string command_line;
-            for (auto a = begin(arguments); a != end(arguments); ++a)
+            command_line.reserve(length);
+            command_line += L"\"";
+            command_line += executable;
+            command_line += L"\"";
+            for (Si::os_string const &argument : arguments)
             {
-                if (a != begin(arguments))
-                {
-                    command_line += L" ";
-                }
-                command_line += *a;
+                command_line += L" ";
+                command_line += argument;
             }
             return command_line;
         }
@@ -136,278 +212,382 @@ namespace ventura
             std::replace(result.begin(), result.end(), L'/', L'\\');
             return result;
         }
-    }
 
-    inline Si::error_or<async_process>
-    launch_process(async_process_parameters parameters, Si::native_file_descriptor standard_input,
-                   Si::native_file_descriptor standard_output, Si::native_file_descriptor standard_error,
-                   std::vector<std::pair<Si::os_char const *, Si::os_char const *>> environment,
-                   environment_inheritance inheritance)
-    {
-        std::vector<Si::os_string> all_arguments;
-        all_arguments.emplace_back(L"\"" + detail::to_create_process_path(parameters.executable) + L"\"");
-        all_arguments.insert(all_arguments.end(), parameters.arguments.begin(), parameters.arguments.end());
-        Si::win32::winapi_string command_line = detail::build_command_line(all_arguments);
-
-        STARTUPINFOW startup = {};
-        startup.cb = sizeof(startup);
-        startup.dwFlags |= STARTF_USESTDHANDLES;
-        startup.hStdError = standard_error;
-        startup.hStdInput = standard_input;
-        startup.hStdOutput = standard_output;
-
-        DWORD flags = CREATE_NO_WINDOW;
-        std::vector<WCHAR> environment_block;
-        if (!environment.empty() || (inheritance == environment_inheritance::no_inherit))
+        /// @param arguments replaces parameters.arguments so that callers can pass arguments without copying them
+        inline Si::error_or<async_process>
+        launch_process(async_process_parameters const &parameters, Si::iterator_range<Si::os_string const *> arguments,
+                       Si::native_file_descriptor standard_input, Si::native_file_descriptor standard_output,
+                       Si::native_file_descriptor standard_error,
+                       std::vector<std::pair<Si::os_char const *, Si::os_char const *>> environment,
+                       environment_inheritance inheritance)
         {
-            flags |= CREATE_UNICODE_ENVIRONMENT;
+            Si::win32::winapi_string command_line =
+                detail::build_command_line(detail::to_create_process_path(parameters.executable), arguments);
+
+            STARTUPINFOW startup = {};
+            startup.cb = sizeof(startup);
+            startup.dwFlags |= STARTF_USESTDHANDLES;
+            startup.hStdError = standard_error;
+            startup.hStdInput = standard_input;
+            startup.hStdOutput = standard_output;
+
+            DWORD flags = CREATE_NO_WINDOW;
+            std::vector<WCHAR> environment_block;
+            if (!environment.empty() || (inheritance == environment_inheritance::no_inherit))
+            {
+                flags |= CREATE_UNICODE_ENVIRONMENT;
 
-            //@environment will contain pointers into this block of memory:
-            std::vector<Si::os_char> mutable_parent_variables;
+                //@environment will contain pointers into this block of memory:
+                std::vector<Si::os_char> mutable_parent_variables;
 
-            switch (
+                switch (
 #if SILICIUM_VC2012
-                static_cast<int>
+                    static_cast<int>
 #endif
-                (inheritance))
-            {
-            case environment_inheritance::inherit:
-            {
-                Si::os_char const *const parent_variables = GetEnvironmentStringsW();
-                Si::os_char const *terminator_found = parent_variables;
-                while (*terminator_found != L'\0')
+                    (inheritance))
                 {
-                    terminator_found += wcslen(terminator_found) + 1;
-                }
-                mutable_parent_variables.assign(parent_variables, terminator_found + 1);
-                for (auto i = mutable_parent_variables.begin(); *i != L'\0';)
+                case environment_inheritance::inherit:
                 {
-                    auto assign = std::find(i, mutable_parent_variables.end(), L'=');
-                    if (assign == i)
+                    Si::os_char const *const parent_variables = GetEnvironmentStringsW();
+                    Si::os_char const *terminator_found = parent_variables;
+                    while (*terminator_found != L'\0')
+                    {
+                        terminator_found += wcslen(terminator_found) + 1;
+                    }
+                    mutable_parent_variables.assign(parent_variables, terminator_found + 1);
+                    for (auto i = mutable_parent_variables.begin(); *i != L'\0';)
                     {
-                        // There is a variable called "=C:" that is generated by Windows (1).
-                        // The equality sign is not allowed in a variable name (2), but
-                        // they do it anyway.
-                        //(1)
-                        // https://msdn.microsoft.com/en-us/library/windows/desktop/ms682425%28v=vs.85%29.aspx
-                        //(2)
-                        // https://msdn.microsoft.com/en-us/library/windows/desktop/ms682653%28v=vs.85%29.aspx
-                        // The solution here: Treat any leading equality sign as a part of the
-                        // name
-                        // to keep this simply.
-                        assign = std::find(assign + 1, mutable_parent_variables.end(), L'=');
+                        auto assign = std::find(i, mutable_parent_variables.end(), L'=');
+                        if (assign == i)
+                        {
+                            // There is a variable called "=C:" that is generated by Windows (1).
+                            // The equality sign is not allowed in a variable name (2), but
+                            // they do it anyway.
+                            //(1)
+                            // https://msdn.microsoft.com/en-us/library/windows/desktop/ms682425%28v=vs.85%29.aspx
+                            //(2)
+                            // https://msdn.microsoft.com/en-us/library/windows/desktop/ms682653%28v=vs.85%29.aspx
+                            // The solution here: Treat any leading equality sign as a part of the
+                            // name
+                            // to keep this simply.
+                            assign = std::find(assign + 1, mutable_parent_variables.end(), L'=');
+                        }
+                        *assign = L'\0';
+                        Si::os_char const *const key = &*i;
+                        Si::os_char const *const value = (&*assign) + 1;
+                        environment.emplace_back(std::make_pair(key, value));
+                        i = assign + 1 + wcslen(value) + 1;
                     }
-                    *assign = L'\0';
-                    Si::os_char const *const key = &*i;
-                    Si::os_char const *const value = (&*assign) + 1;
-                    environment.emplace_back(std::make_pair(key, value));
-                    i = assign + 1 + wcslen(value) + 1;
+                    break;
                 }
-                break;
-            }
 
-            case environment_inheritance::no_inherit:
-            {
-                break;
-            }
-            }
+                case environment_inheritance::no_inherit:
+                {
+                    break;
+                }
+                }
 
-            typedef std::pair<Si::os_char const *, Si::os_char const *> environment_entry;
-            std::sort(environment.begin(), environment.end(),
-                      [](environment_entry const &left, environment_entry const &right)
-                      {
-                          return (wcscmp(left.first, right.first) < 0);
-                      });
-            for (environment_entry const &entry : environment)
-            {
-                environment_block.insert(environment_block.end(), entry.first, entry.first + wcslen(entry.first));
-                environment_block.emplace_back('=');
-                std::size_t const zero_terminated = 1;
-                environment_block.insert(environment_block.end(), entry.second,
-                                         entry.second + wcslen(entry.second) + zero_terminated);
-            }
-            if (environment_block.empty())
-            {
+                typedef std::pair<Si::os_char const *, Si::os_char const *> environment_entry;
+                std::sort(environment.begin(), environment.end(),
+                          [](environment_entry const &left, environment_entry const &right)
+                          {
+                              return (wcscmp(left.first, right.first) < 0);
+                          });
+                for (environment_entry const &entry : environment)
                 {
-                    auto const key_and_assignment = Si::make_c_str_range(L"=C:=");
-                    environment_block.insert(environment_block.end(), key_and_assignment.begin(),
-                                             key_and_assignment.end());
+                    environment_block.insert(environment_block.end(), entry.first, entry.first + wcslen(entry.first));
+                    environment_block.emplace_back('=');
+                    std::size_t const zero_terminated = 1;
+                    environment_block.insert(environment_block.end(), entry.second,
+                                             entry.second + wcslen(entry.second) + zero_terminated);
                 }
-                std::size_t const begin_of_value = environment_block.size();
-                std::size_t estimated_value_size = 10;
-                for (;;)
+                if (environment_block.empty())
                 {
-                    std::size_t const size_including_buffer =
-                        std::max(environment_block.size(), begin_of_value + estimated_value_size);
-                    environment_block.resize(size_including_buffer);
-                    DWORD const buffer_size = static_cast<DWORD>(size_including_buffer - begin_of_value);
-                    DWORD const actual_value_size =
-                        GetEnvironmentVariableW(L"=C:", environment_block.data() + begin_of_value, buffer_size);
-                    if (actual_value_size <= buffer_size)
                     {
-                        environment_block.resize(begin_of_value + actual_value_size + 1);
-                        break;
+                        auto const key_and_assignment = Si::make_c_str_range(L"=C:=");
+                        environment_block.insert(environment_block.end(), key_and_assignment.begin(),
+                                                 key_and_assignment.end());
+                    }
+                    std::size_t const begin_of_value = environment_block.size();
+                    std::size_t estimated_value_size = 10;
+                    for (;;)
+                    {
+                        std::size_t const size_including_buffer =
+                            std::max(environment_block.size(), begin_of_value + estimated_value_size);
+                        environment_block.resize(size_including_buffer);
+                        DWORD const buffer_size = static_cast<DWORD>(size_including_buffer - begin_of_value);
+                        DWORD const actual_value_size =
+                            GetEnvironmentVariableW(L"=C:", environment_block.data() + begin_of_value, buffer_size);
+                        if (actual_value_size <= buffer_size)
+                        {
+                            environment_block.resize(begin_of_value + actual_value_size + 1);
+                            break;
+                        }
+                        estimated_value_size = actual_value_size;
                     }
-                    estimated_value_size = actual_value_size;
                 }
+                environment_block.emplace_back(L'\0');
             }
-            environment_block.emplace_back(L'\0');
-        }
 
-        PROCESS_INFORMATION process = {};
-        if (!CreateProcessW(detail::to_create_process_path(parameters.executable).c_str(), &command_line[0], nullptr,
-                            nullptr, TRUE, flags, environment_block.empty() ? NULL : environment_block.data(),
-                            detail::to_create_process_path(parameters.current_path).c_str(), &startup, &process))
-        {
-            return Si::get_last_error();
-        }
+            PROCESS_INFORMATION process = {};
+            if (!CreateProcessW(detail::to_create_process_path(parameters.executable).c_str(), &command_line[0],
+                                nullptr, nullptr, TRUE, flags,
+                                environment_block.empty() ? NULL : environment_block.data(),
+                                detail::to_create_process_path(parameters.current_path).c_str(), &startup, &process))
+            {
+                return Si::get_last_error();
+            }
 
-        Si::win32::unique_handle thread_closer(process.hThread);
-        process_handle process_closer(process.hProcess);
-        return async_process(std::move(process_closer));
+            Si::win32::unique_handle thread_closer(process.hThread);
+            process_handle process_closer(process.hProcess);
+            return async_process(std::move(process_closer));
+        }
     }
-#else
+
     inline Si::error_or<async_process>
-    launch_process(async_process_parameters parameters, Si::native_file_descriptor standard_input,
+    launch_process(async_process_parameters const &parameters, Si::native_file_descriptor standard_input,
                    Si::native_file_descriptor standard_output, Si::native_file_descriptor standard_error,
                    std::vector<std::pair<Si::os_char const *, Si::os_char const *>> environment,
                    environment_inheritance inheritance)
     {
-        auto executable = parameters.executable.underlying();
-        auto arguments = parameters.arguments;
-        std::vector<char *> argument_pointers;
-        argument_pointers.emplace_back(const_cast<char *>(executable.c_str()));
-        std::transform(begin(arguments), end(arguments), std::back_inserter(argument_pointers),
-                       [](Si::noexcept_string &arg)
-                       {
-                           return &arg[0];
-                       });
-        argument_pointers.emplace_back(nullptr);
-
-        Si::pipe child_error = Si::make_pipe().move_value();
-
-        pid_t const forked = fork();
-        if (forked < 0)
+        return detail::launch_process(parameters, detail::all_arguments(parameters), standard_input, standard_output,
+                                      standard_error, std::move(environment), inheritance);
+    }
+#else
+    namespace detail
+    {
+        /// The argv of exec. All strings are copied into a single block so that building it takes two allocations
+        /// regardless of the number of arguments.
+        struct argument_vector
         {
-            return boost::system::error_code(errno, boost::system::system_category());
-        }
+            std::vector<char> characters;
+            std::vector<char *> pointers;
+        };
 
-        // child
-        if (forked == 0)
+        inline argument_vector make_argument_vector(absolute_path const &executable,
+                                                    Si::iterator_range<Si::os_string const *> arguments)
         {
-            auto const fail_with_error = [&child_error](int error) SILICIUM_NORETURN
+            std::size_t total_size = executable.underlying().size() + 1;
+            for (Si::os_string const &argument : arguments)
             {
-                ssize_t written = write(child_error.write.handle, &error, sizeof(error));
-                if (written != sizeof(error))
-                {
-                    _exit(1);
-                }
-                child_error.write.close();
-                _exit(0);
-            };
-
-            auto const fail = [fail_with_error]() SILICIUM_NORETURN
-            {
-                fail_with_error(errno);
-            };
-
-            if (dup2(standard_output, STDOUT_FILENO) < 0)
-            {
-                fail();
+                total_size += argument.size() + 1;
             }
-            if (dup2(standard_error, STDERR_FILENO) < 0)
+            argument_vector result;
+            result.characters.resize(total_size);
+            result.pointers.reserve(static_cast<std::size_t>(arguments.end() - arguments.begin()) + 2);
+            char *next = result.characters.data();
+            auto const append = [&result, &next](char const *data, std::size_t size)
             {
-                fail();
-            }
-            if (dup2(standard_input, STDIN_FILENO) < 0)
+                result.pointers.emplace_back(next);
+                next = std::copy_n(data, size, next);
+                *next = '\0';
+                ++next;
+            };
+            append(executable.c_str(), executable.underlying().size());
+            for (Si::os_string const &argument : arguments)
             {
-                fail();
+                append(argument.data(), argument.size());
             }
+            assert(next == (result.characters.data() + result.characters.size()));
+            result.pointers.emplace_back(nullptr);
+            return result;
+        }
 
-            child_error.read.close();
+        /// @param arguments replaces parameters.arguments so that callers can pass arguments without copying them
+        inline Si::error_or<async_process>
+        launch_process(async_process_parameters const &parameters, Si::iterator_range<Si::os_string const *> arguments,
+                       Si::native_file_descriptor standard_input, Si::native_file_descriptor standard_output,
+                       Si::native_file_descriptor standard_error,
+                       std::vector<std::pair<Si::os_char const *, Si::os_char const *>> const &environment,
+                       environment_inheritance inheritance)
+        {
+            argument_vector const argv = make_argument_vector(parameters.executable, arguments);
 
-            boost::system::error_code ec = Si::detail::set_close_on_exec(child_error.write.handle);
-            if (ec)
-            {
-                fail_with_error(ec.value());
-            }
+            Si::pipe child_error = Si::make_pipe().move_value();
 
-            boost::filesystem::current_path(parameters.current_path.to_boost_path(), ec);
-            if (ec)
+            pid_t const forked = fork();
+            if (forked < 0)
             {
-                fail_with_error(ec.value());
+                return boost::system::error_code(errno, boost::system::system_category());
             }
 
-            // close inherited file descriptors
-            long max_fd = sysconf(_SC_OPEN_MAX);
-            for (int i = 3; i < max_fd; ++i)
+            // child
+            if (forked == 0)
             {
-                if (i == child_error.write.handle)
+                auto const fail_with_error = [&child_error](int error) SILICIUM_NORETURN
+                {
+                    ssize_t written = write(child_error.write.handle, &error, sizeof(error));
+                    if (written != sizeof(error))
+                    {
+                        _exit(1);
+                    }
+                    child_error.write.close();
+                    _exit(0);
+                };
+
+                auto const fail = [fail_with_error]() SILICIUM_NORETURN
+                {
+                    fail_with_error(errno);
+                };
+
+                if (dup2(standard_output, STDOUT_FILENO) < 0)
                 {
-                    continue;
+                    fail();
+                }
+                if (dup2(standard_error, STDERR_FILENO) < 0)
+                {
+                    fail();
+                }
+                if (dup2(standard_input, STDIN_FILENO) < 0)
+                {
+                    fail();
+                }
+
+                if (parameters.own_process_group && (setpgid(0, 0) < 0))
+                {
+                    fail();
+                }
+
+                child_error.read.close();
+
+                boost::system::error_code ec = Si::detail::set_close_on_exec(child_error.write.handle);
+                if (ec)
+                {
+                    fail_with_error(ec.value());
+                }
+
+                boost::filesystem::current_path(parameters.current_path.to_boost_path(), ec);
+                if (ec)
+                {
+                    fail_with_error(ec.value());
+                }
+
+                for (Si::native_file_descriptor const inherited : parameters.inherited_file_descriptors)
+                {
+                    if (fcntl(inherited, F_SETFD, 0) < 0)
+                    {
+                        fail();
+                    }
+                }
+
+                // close inherited file descriptors
+                long max_fd = sysconf(_SC_OPEN_MAX);
+                for (int i = 3; i < max_fd; ++i)
+                {
+                    if ((i == child_error.write.handle) || (i == parameters.executable_file) ||
+                        (std::find(parameters.inherited_file_descriptors.begin(),
+                                   parameters.inherited_file_descriptors.end(),
+                                   i) != parameters.inherited_file_descriptors.end()))
+                    {
+                        continue;
+                    }
+                    close(i); // ignore errors because we will close many non-file-descriptors
+                }
+
+                int const scheduling_error = detail::apply_scheduling(parameters.scheduling);
+                if (scheduling_error != 0)
+                {
+                    fail_with_error(scheduling_error);
                 }
-                close(i); // ignore errors because we will close many non-file-descriptors
-            }
 
 #ifdef __linux__
-            // kill the child when the parent exits
-            if (prctl(PR_SET_PDEATHSIG, SIGHUP) < 0)
-            {
-                fail();
-            }
+                // kill the child when the parent exits
+                if (prctl(PR_SET_PDEATHSIG, SIGHUP) < 0)
+                {
+                    fail();
+                }
 #else
-// TODO: OSX etc
+    // TODO: OSX etc
 #endif
 
-            switch (inheritance)
-            {
-            case environment_inheritance::inherit:
-                for (auto const &var : environment)
+                switch (inheritance)
                 {
-                    int result = setenv(var.first, var.second, 1);
-                    if (result != 0)
+                case environment_inheritance::inherit:
+                    for (auto const &var : environment)
                     {
-                        fail_with_error(errno);
+                        int result = setenv(var.first, var.second, 1);
+                        if (result != 0)
+                        {
+                            fail_with_error(errno);
+                        }
                     }
-                }
-                execvp(parameters.executable.c_str(), argument_pointers.data());
-                fail();
-                break;
+#if VENTURA_HAS_FEXECVE
+                    if (parameters.executable_file >= 0)
+                    {
+                        fexecve(parameters.executable_file, argv.pointers.data(), environ);
+                        // A script cannot be run from a close-on-exec descriptor because the interpreter would not be
+                        // able to open it, so scripts take the slower path.
+                        if (errno != ENOENT)
+                        {
+                            fail();
+                        }
+                    }
+#endif
+                    execvp(parameters.executable.c_str(), argv.pointers.data());
+                    fail();
+                    break;
 
-            case environment_inheritance::no_inherit:
-            {
-                std::vector<char *> environment_for_exec;
-                for (auto const &entry : environment)
+                case environment_inheritance::no_inherit:
                 {
-                    auto const first_length = std::strlen(entry.first);
-                    auto const second_length = std::strlen(entry.second);
-                    char *const formatted = new char[first_length + 1 + second_length + 1];
-                    std::copy_n(entry.first, first_length, formatted);
-                    formatted[first_length] = '=';
-                    std::copy_n(entry.second, second_length, formatted + first_length + 1);
-                    formatted[first_length + 1 + second_length] = '\0';
-                    environment_for_exec.emplace_back(formatted);
-                }
-                environment_for_exec.emplace_back(nullptr);
+                    std::vector<char *> environment_for_exec;
+                    for (auto const &entry : environment)
+                    {
+                        auto const first_length = std::strlen(entry.first);
+                        auto const second_length = std::strlen(entry.second);
+                        char *const formatted = new char[first_length + 1 + second_length + 1];
+                        std::copy_n(entry.first, first_length, formatted);
+                        formatted[first_length] = '=';
+                        std::copy_n(entry.second, second_length, formatted + first_length + 1);
+                        formatted[first_length + 1 + second_length] = '\0';
+                        environment_for_exec.emplace_back(formatted);
+                    }
+                    environment_for_exec.emplace_back(nullptr);
+#if VENTURA_HAS_FEXECVE
+                    if (parameters.executable_file >= 0)
+                    {
+                        fexecve(parameters.executable_file, argv.pointers.data(), environment_for_exec.data());
+                        if (errno != ENOENT)
+                        {
+                            fail();
+                        }
+                    }
+#endif
 #ifdef __linux__
-                execvpe
+                    execvpe
 #else
-                execve
+                    execve
 #endif
-                    (parameters.executable.c_str(), argument_pointers.data(), environment_for_exec.data());
-                fail();
-                break;
-            }
+                        (parameters.executable.c_str(), argv.pointers.data(), environment_for_exec.data());
+                    fail();
+                    break;
+                }
+                }
+
+                SILICIUM_UNREACHABLE();
             }
 
-            SILICIUM_UNREACHABLE();
+            // parent
+            else
+            {
+                if (parameters.own_process_group)
+                {
+                    // The child does the same. Doing it here, too, guarantees that the group exists when this function
+                    // returns. Fails harmlessly if the child has already called exec.
+                    setpgid(forked, forked);
+                }
+                return async_process(process_handle(forked), std::move(child_error.read));
+            }
         }
+    }
 
-        // parent
-        else
-        {
-            return async_process(process_handle(forked), std::move(child_error.read));
-        }
+    inline Si::error_or<async_process>
+    launch_process(async_process_parameters const &parameters, Si::native_file_descriptor standard_input,
+                   Si::native_file_descriptor standard_output, Si::native_file_descriptor standard_error,
+                   std::vector<std::pair<Si::os_char const *, Si::os_char const *>> const &environment,
+                   environment_inheritance inheritance)
+    {
+        return detail::launch_process(parameters, detail::all_arguments(parameters), standard_input, standard_output,
+                                      standard_error, environment, inheritance);
     }
 #endif
 
@@ -0,0 +1,52 @@
+#ifndef VENTURA_DETAIL_ALIGNED_BUFFER_HPP
+#define VENTURA_DETAIL_ALIGNED_BUFFER_HPP
+
+#include <boost/throw_exception.hpp>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace ventura
+{
+    namespace detail
+    {
+        struct aligned_free
+        {
+            void operator()(char *memory) const BOOST_NOEXCEPT
+            {
+#ifdef _WIN32
+                _aligned_free(memory);
+#else
+                std::free(memory);
+#endif
+            }
+        };
+
+        typedef std::unique_ptr<char, aligned_free> aligned_buffer;
+
+        /// @param alignment a power of two and a multiple of sizeof(void *)
+        inline aligned_buffer allocate_aligned(std::size_t size, std::size_t alignment)
+        {
+#ifdef _WIN32
+            void *const memory = _aligned_malloc(size, alignment);
+            if (!memory)
+            {
+                boost::throw_exception(std::bad_alloc());
+            }
+#else
+            void *memory = nullptr;
+            if (posix_memalign(&memory, alignment, size) != 0)
+            {
+                boost::throw_exception(std::bad_alloc());
+            }
+#endif
+            return aligned_buffer(static_cast<char *>(memory));
+        }
+    }
+}
+
+#endif
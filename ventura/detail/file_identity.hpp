@@ -0,0 +1,51 @@
+#ifndef VENTURA_DETAIL_FILE_IDENTITY_HPP
+#define VENTURA_DETAIL_FILE_IDENTITY_HPP
+
+#include <boost/config.hpp>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace ventura
+{
+#ifndef _WIN32
+    namespace detail
+    {
+        /// Tells whether a path still refers to the same unmodified file as before.
+        struct file_identity
+        {
+            dev_t device;
+            ino_t inode;
+            off_t size;
+            time_t modification_seconds;
+            long modification_nanoseconds;
+        };
+
+        inline file_identity make_file_identity(struct stat const &status) BOOST_NOEXCEPT
+        {
+            file_identity result;
+            result.device = status.st_dev;
+            result.inode = status.st_ino;
+            result.size = status.st_size;
+#ifdef __APPLE__
+            result.modification_seconds = status.st_mtimespec.tv_sec;
+            result.modification_nanoseconds = status.st_mtimespec.tv_nsec;
+#else
+            result.modification_seconds = status.st_mtim.tv_sec;
+            result.modification_nanoseconds = status.st_mtim.tv_nsec;
+#endif
+            return result;
+        }
+
+        inline bool operator==(file_identity const &left, file_identity const &right) BOOST_NOEXCEPT
+        {
+            return (left.device == right.device) && (left.inode == right.inode) && (left.size == right.size) &&
+                   (left.modification_seconds == right.modification_seconds) &&
+                   (left.modification_nanoseconds == right.modification_nanoseconds);
+        }
+    }
+#endif
+}
+
+#endif
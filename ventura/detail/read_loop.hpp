@@ -0,0 +1,192 @@
+#ifndef VENTURA_DETAIL_READ_LOOP_HPP
+#define VENTURA_DETAIL_READ_LOOP_HPP
+
+#include <ventura/access_pattern.hpp>
+#include <ventura/detail/file_identity.hpp>
+#include <silicium/error_or.hpp>
+#include <silicium/file_handle.hpp>
+#include <silicium/get_last_error.hpp>
+#include <silicium/read.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ventura
+{
+    namespace detail
+    {
+        /// the first buffer size for reading a file of unknown size, which is enough for most files in /proc
+        std::size_t const initial_unknown_read_size = 4096;
+
+        /// The largest amount that is requested by one read. Linux transfers at most about 2 GiB per call anyway, and
+        /// ReadFile takes a 32 bit size.
+        std::size_t const max_read_chunk = 1024 * 1024 * 1024;
+
+        /// files at least this large are announced to the system before they are read
+        std::size_t const whole_file_hint_threshold = 1024 * 1024;
+
+        /// what is needed to tell whether a file has been modified while it was being read
+        struct file_version
+        {
+            bool regular;
+            boost::uint64_t size;
+#ifdef _WIN32
+            boost::uint64_t last_write;
+#else
+            file_identity identity;
+#endif
+        };
+
+        inline bool operator==(file_version const &left, file_version const &right) BOOST_NOEXCEPT
+        {
+            return (left.regular == right.regular) && (left.size == right.size) &&
+#ifdef _WIN32
+                   (left.last_write == right.last_write);
+#else
+                   (left.identity == right.identity);
+#endif
+        }
+
+        inline Si::error_or<file_version> get_file_version(Si::native_file_descriptor file)
+        {
+            file_version result;
+#ifdef _WIN32
+            BY_HANDLE_FILE_INFORMATION information;
+            if (!GetFileInformationByHandle(file, &information))
+            {
+                return Si::get_last_error();
+            }
+            result.regular = (GetFileType(file) == FILE_TYPE_DISK) &&
+                             ((information.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0);
+            result.size = (static_cast<boost::uint64_t>(information.nFileSizeHigh) << 32u) | information.nFileSizeLow;
+            result.last_write = (static_cast<boost::uint64_t>(information.ftLastWriteTime.dwHighDateTime) << 32u) |
+                                information.ftLastWriteTime.dwLowDateTime;
+#else
+            struct stat status;
+            if (fstat(file, &status) < 0)
+            {
+                return Si::get_last_error();
+            }
+            result.regular = S_ISREG(status.st_mode);
+            result.size = static_cast<boost::uint64_t>(status.st_size);
+            result.identity = make_file_identity(status);
+#endif
+            return result;
+        }
+
+        /// reads at least one byte unless the end of the file has been reached, and retries when interrupted by a
+        /// signal
+        inline Si::error_or<std::size_t> read_some(Si::native_file_descriptor file, char *destination,
+                                                   std::size_t size)
+        {
+            size = (std::min)(size, max_read_chunk);
+#ifdef _WIN32
+            return Si::read(file, Si::make_iterator_range(destination, destination + size));
+#else
+            for (;;)
+            {
+                ssize_t const read = ::read(file, destination, size);
+                if (read >= 0)
+                {
+                    return static_cast<std::size_t>(read);
+                }
+                if (errno != EINTR)
+                {
+                    return Si::get_last_error();
+                }
+            }
+#endif
+        }
+
+        /// Reads a file whose size is known in large chunks. The kernel may return less than requested for various
+        /// reasons (large sizes, signals), which is normal and handled by reading again. Whether the file has been
+        /// modified is decided by comparing its size and modification time with the version from before.
+        /// @param before the version of the file that told the size
+        /// @return the number of bytes read, which is less than size when the file ends earlier than its size
+        /// suggests (sysfs for example) without having been modified, or none if the file has been modified
+        inline Si::error_or<Si::optional<std::size_t>> read_known_size(Si::native_file_descriptor file,
+                                                                        char *destination, std::size_t size,
+                                                                        file_version const &before)
+        {
+#if VENTURA_HAS_ACCESS_HINTS
+            if (size >= whole_file_hint_threshold)
+            {
+                // the system can read ahead everything at once instead of growing its window step by step
+                advise(file, 0, 0, POSIX_FADV_SEQUENTIAL);
+                advise(file, 0, size, POSIX_FADV_WILLNEED);
+            }
+#endif
+            std::size_t used = 0;
+            while (used < size)
+            {
+                Si::error_or<std::size_t> const read = read_some(file, destination + used, size - used);
+                if (read.is_error())
+                {
+                    return read.error();
+                }
+                if (read.get() == 0)
+                {
+                    break;
+                }
+                used += read.get();
+            }
+            Si::error_or<file_version> const after = get_file_version(file);
+            if (after.is_error())
+            {
+                return after.error();
+            }
+            if (!(after.get() == before))
+            {
+                return Si::optional<std::size_t>();
+            }
+            return Si::optional<std::size_t>(used);
+        }
+
+        /// Reads until the end of a file whose size is unknown (pipes, FIFOs, procfs and sysfs). The buffer grows
+        /// geometrically, so every byte is copied about once more at most. The content is appended.
+        /// @param content a contiguous container of char like std::vector<char> or std::string
+        /// @return false if the file has more than limit bytes, or more than the container can hold. content then
+        /// contains more than limit bytes and the rest of the file has not been read.
+        template <class ByteContainer>
+        Si::error_or<bool> read_until_end(Si::native_file_descriptor file, ByteContainer &content, std::size_t limit)
+        {
+            // reading one byte more than the limit tells whether the limit is exceeded
+            std::size_t const capacity = (limit < content.max_size()) ? (limit + 1) : content.max_size();
+            std::size_t used = content.size();
+            for (;;)
+            {
+                if (used == content.size())
+                {
+                    if (used >= capacity)
+                    {
+                        return false;
+                    }
+                    std::size_t const grown = (used > (capacity / 2))
+                                                  ? capacity
+                                                  : (std::max)(used * 2, initial_unknown_read_size);
+                    content.resize((std::min)(grown, capacity));
+                }
+                // data() of std::string is const before C++17
+                Si::error_or<std::size_t> const read = read_some(file, &content[0] + used, content.size() - used);
+                if (read.is_error())
+                {
+                    content.resize(used);
+                    return read.error();
+                }
+                if (read.get() == 0)
+                {
+                    content.resize(used);
+                    return true;
+                }
+                used += read.get();
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,326 @@
+#ifndef VENTURA_DURABILITY_COORDINATOR_HPP
+#define VENTURA_DURABILITY_COORDINATOR_HPP
+
+#include <silicium/config.hpp>
+#include <silicium/file_handle.hpp>
+#include <silicium/get_last_error.hpp>
+#include <boost/system/error_code.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+#define VENTURA_HAS_DURABILITY_COORDINATOR 1
+#else
+#define VENTURA_HAS_DURABILITY_COORDINATOR 0
+#endif
+
+#if VENTURA_HAS_DURABILITY_COORDINATOR
+namespace ventura
+{
+    enum class durability_mode
+    {
+        /// fdatasync (fsync on OS X) for every file of a group. Data survives a crash of the machine.
+        data_sync,
+
+        /// Only starts the writeback of the dirty pages with sync_file_range(SYNC_FILE_RANGE_WRITE) and does not wait
+        /// for it. This bounds the amount of dirty data, but survives only a crash of the process. Falls back to
+        /// data_sync where sync_file_range does not exist.
+        write_behind,
+
+        /// For files opened with O_DSYNC (see open_synchronous_writing) where every write is already durable when it
+        /// returns. Commits are only reported.
+        synchronous_writes
+    };
+
+    /// Batches sync requests from many files and threads (group commit). A request that arrives while a group is
+    /// being synced waits for the next group, which covers all requests that have arrived in the meantime. Requests
+    /// for the same file share one system call. On Linux in data_sync mode, the files of a group that are on the same
+    /// file system are made durable with a single syncfs when there are at least filesystem_sync_threshold of them,
+    /// so that hundreds of journals flushed by their own sinks do not cost one fdatasync each.
+    struct durability_coordinator
+    {
+        typedef std::function<void(boost::system::error_code)> commit_handler;
+
+        /// The number of files on one file system in a group from which on syncfs is used instead of an fdatasync
+        /// for each of them. syncfs also writes unrelated dirty data of the file system, so it only pays off for
+        /// several files.
+        static std::size_t const filesystem_sync_threshold = 4;
+
+        /// @param gather_delay how long the coordinator waits for more requests before it starts a group. Zero
+        /// starts immediately, which still groups everything that arrives during a sync.
+        explicit durability_coordinator(durability_mode mode,
+                                        std::chrono::microseconds gather_delay = std::chrono::microseconds(0))
+            : m_mode(mode)
+            , m_gather_delay(gather_delay)
+            , m_stopping(false)
+            , m_requests(0)
+            , m_system_calls(0)
+        {
+            m_worker = std::thread([this]()
+                                   {
+                                       work();
+                                   });
+        }
+
+        /// completes all requests before returning
+        ~durability_coordinator()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_requested.notify_all();
+            m_worker.join();
+        }
+
+        /// Returns immediately. The handler is called on the thread of the coordinator when everything that has been
+        /// written to the file before this call has been made durable. It must not throw. The file has to stay open
+        /// until then.
+        void request_sync(Si::native_file_descriptor file, commit_handler on_committed)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_pending.emplace_back(request{file, std::move(on_committed)});
+                ++m_requests;
+            }
+            m_requested.notify_all();
+        }
+
+        /// blocks until the file is durable
+        SILICIUM_USE_RESULT
+        boost::system::error_code sync(Si::native_file_descriptor file)
+        {
+            std::promise<boost::system::error_code> committed;
+            std::future<boost::system::error_code> result = committed.get_future();
+            request_sync(file, [&committed](boost::system::error_code error)
+                         {
+                             committed.set_value(error);
+                         });
+            return result.get();
+        }
+
+        durability_mode mode() const BOOST_NOEXCEPT
+        {
+            return m_mode;
+        }
+
+        /// the number of requests so far
+        std::size_t requests() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_requests;
+        }
+
+        /// the number of syncs that were needed for the requests so far
+        std::size_t system_calls() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_system_calls;
+        }
+
+    private:
+        struct request
+        {
+            Si::native_file_descriptor file;
+            commit_handler on_committed;
+        };
+
+        typedef std::pair<Si::native_file_descriptor, boost::system::error_code> file_result;
+
+        durability_mode const m_mode;
+        std::chrono::microseconds const m_gather_delay;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_requested;
+        std::vector<request> m_pending;
+        bool m_stopping;
+        std::size_t m_requests;
+        std::size_t m_system_calls;
+        std::thread m_worker;
+
+        void work()
+        {
+            std::vector<request> group;
+            std::vector<file_result> results;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                m_requested.wait(lock, [this]()
+                                 {
+                                     return m_stopping || !m_pending.empty();
+                                 });
+                if (m_pending.empty())
+                {
+                    assert(m_stopping);
+                    return;
+                }
+                if (m_gather_delay.count() > 0)
+                {
+                    m_requested.wait_for(lock, m_gather_delay, [this]()
+                                         {
+                                             return m_stopping;
+                                         });
+                }
+                group.clear();
+                group.swap(m_pending);
+                lock.unlock();
+
+                results.clear();
+                for (request const &waiting : group)
+                {
+                    results.emplace_back(waiting.file, boost::system::error_code());
+                }
+                // one system call per file covers all requests of the group for that file
+                std::sort(results.begin(), results.end(), [](file_result const &left, file_result const &right)
+                          {
+                              return left.first < right.first;
+                          });
+                results.erase(std::unique(results.begin(), results.end(),
+                                          [](file_result const &left, file_result const &right)
+                                          {
+                                              return left.first == right.first;
+                                          }),
+                              results.end());
+                std::size_t system_calls = 0;
+                sync_files(results, system_calls);
+                {
+                    std::lock_guard<std::mutex> counting(m_mutex);
+                    m_system_calls += system_calls;
+                }
+                for (request &committed : group)
+                {
+                    auto const found = std::lower_bound(results.begin(), results.end(), committed.file,
+                                                        [](file_result const &left, Si::native_file_descriptor right)
+                                                        {
+                                                            return left.first < right;
+                                                        });
+                    assert(found != results.end());
+                    committed.on_committed(found->second);
+                }
+
+                lock.lock();
+            }
+        }
+
+        void sync_files(std::vector<file_result> &files, std::size_t &system_calls)
+        {
+#ifdef __linux__
+            if ((m_mode == durability_mode::data_sync) && (files.size() >= filesystem_sync_threshold))
+            {
+                sync_by_file_system(files, system_calls);
+                return;
+            }
+#endif
+            for (file_result &file : files)
+            {
+                file.second = sync_file(file.first, system_calls);
+            }
+        }
+
+#ifdef __linux__
+        /// syncfs reports write errors of the files only since Linux 5.8.
+        static void sync_by_file_system(std::vector<file_result> &files, std::size_t &system_calls)
+        {
+            typedef std::pair<dev_t, std::size_t> device_file;
+            std::vector<device_file> devices;
+            for (std::size_t i = 0; i < files.size(); ++i)
+            {
+                struct stat status;
+                if (fstat(files[i].first, &status) < 0)
+                {
+                    files[i].second = Si::get_last_error();
+                    continue;
+                }
+                devices.emplace_back(status.st_dev, i);
+            }
+            std::sort(devices.begin(), devices.end());
+            for (auto begin = devices.begin(); begin != devices.end();)
+            {
+                auto const end = std::find_if(begin, devices.end(), [begin](device_file const &device)
+                                              {
+                                                  return device.first != begin->first;
+                                              });
+                if (static_cast<std::size_t>(end - begin) >= filesystem_sync_threshold)
+                {
+                    ++system_calls;
+                    boost::system::error_code error;
+                    if (syncfs(files[begin->second].first) < 0)
+                    {
+                        error = Si::get_last_error();
+                    }
+                    for (auto i = begin; i != end; ++i)
+                    {
+                        files[i->second].second = error;
+                    }
+                }
+                else
+                {
+                    for (auto i = begin; i != end; ++i)
+                    {
+                        files[i->second].second = data_sync(files[i->second].first, system_calls);
+                    }
+                }
+                begin = end;
+            }
+        }
+#endif
+
+        boost::system::error_code sync_file(Si::native_file_descriptor file, std::size_t &system_calls)
+        {
+            switch (m_mode)
+            {
+            case durability_mode::synchronous_writes:
+                return boost::system::error_code();
+
+            case durability_mode::write_behind:
+#ifdef __linux__
+                ++system_calls;
+                if (sync_file_range(file, 0, 0, SYNC_FILE_RANGE_WRITE) < 0)
+                {
+                    return Si::get_last_error();
+                }
+                return boost::system::error_code();
+#else
+                return data_sync(file, system_calls);
+#endif
+
+            case durability_mode::data_sync:
+                return data_sync(file, system_calls);
+            }
+            SILICIUM_UNREACHABLE();
+        }
+
+        static boost::system::error_code data_sync(Si::native_file_descriptor file, std::size_t &system_calls)
+        {
+            ++system_calls;
+            if (
+#ifdef __APPLE__
+                fsync
+#else
+                fdatasync
+#endif
+                (file) < 0)
+            {
+                return Si::get_last_error();
+            }
+            return boost::system::error_code();
+        }
+
+        SILICIUM_DELETED_FUNCTION(durability_coordinator(durability_coordinator const &))
+        SILICIUM_DELETED_FUNCTION(durability_coordinator &operator=(durability_coordinator const &))
+    };
+}
+#endif
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef VENTURA_EXECUTABLE_HANDLE_HPP
+#define VENTURA_EXECUTABLE_HANDLE_HPP
+
+#include <ventura/detail/file_identity.hpp>
+#include <ventura/run_process.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if VENTURA_HAS_RUN_PROCESS && !defined(_WIN32)
+#define VENTURA_HAS_EXECUTABLE_HANDLE 1
+#else
+#define VENTURA_HAS_EXECUTABLE_HANDLE 0
+#endif
+
+#if VENTURA_HAS_EXECUTABLE_HANDLE
+namespace ventura
+{
+    /// An executable that has been opened once so that it can be launched many times without resolving its path
+    /// again. Where fexecve is available, the child executes the opened file directly.
+    struct executable_handle
+    {
+        executable_handle() BOOST_NOEXCEPT : m_identity()
+        {
+        }
+
+        SILICIUM_USE_RESULT
+        static Si::error_or<executable_handle> open(absolute_path path)
+        {
+            Si::native_file_descriptor const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return Si::get_last_error();
+            }
+            Si::file_handle file(fd);
+            struct stat status;
+            if (fstat(file.handle, &status) < 0)
+            {
+                return Si::get_last_error();
+            }
+            if (!S_ISREG(status.st_mode))
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::permission_denied);
+            }
+            return executable_handle(std::move(path), std::move(file), detail::make_file_identity(status));
+        }
+
+        absolute_path const &path() const BOOST_NOEXCEPT
+        {
+            return m_path;
+        }
+
+        Si::native_file_descriptor file() const BOOST_NOEXCEPT
+        {
+            return m_file.handle;
+        }
+
+        /// True if the path now names a different file or if the file has been modified since it was opened.
+        SILICIUM_USE_RESULT
+        bool is_stale() const BOOST_NOEXCEPT
+        {
+            struct stat status;
+            if (stat(m_path.c_str(), &status) < 0)
+            {
+                return true;
+            }
+            return !(detail::make_file_identity(status) == m_identity);
+        }
+
+        /// makes run_process launch this executable
+        void prepare(process_parameters &parameters) const
+        {
+            parameters.executable = m_path;
+            parameters.executable_file = m_file.handle;
+        }
+
+    private:
+        absolute_path m_path;
+        Si::file_handle m_file;
+        detail::file_identity m_identity;
+
+        executable_handle(absolute_path path, Si::file_handle file, detail::file_identity identity) BOOST_NOEXCEPT
+            : m_path(std::move(path)),
+              m_file(std::move(file)),
+              m_identity(identity)
+        {
+        }
+    };
+
+    /// Searches the absolute directories of PATH like execvp does. Relative entries are ignored.
+    SILICIUM_USE_RESULT
+    inline Si::error_or<absolute_path> find_executable(Si::noexcept_string const &name)
+    {
+        if (name.find('/') != Si::noexcept_string::npos)
+        {
+            Si::optional<absolute_path> direct = absolute_path::create(name);
+            if (!direct)
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::invalid_argument);
+            }
+            return std::move(*direct);
+        }
+        char const *const path_variable = std::getenv("PATH");
+        Si::noexcept_string const search_path = path_variable ? path_variable : "/usr/bin:/bin";
+        std::size_t begin = 0;
+        for (;;)
+        {
+            std::size_t const end = (std::min)(search_path.find(':', begin), search_path.size());
+            Si::noexcept_string candidate = search_path.substr(begin, end - begin);
+            candidate += '/';
+            candidate += name;
+            struct stat status;
+            if ((candidate[0] == '/') && (access(candidate.c_str(), X_OK) == 0) &&
+                (stat(candidate.c_str(), &status) == 0) && S_ISREG(status.st_mode))
+            {
+                return *absolute_path::create(candidate);
+            }
+            if (end == search_path.size())
+            {
+                break;
+            }
+            begin = end + 1;
+        }
+        return boost::system::errc::make_error_code(boost::system::errc::no_such_file_or_directory);
+    }
+
+    /// Remembers resolved and opened executables by name. An entry is checked against the file system at most once
+    /// per revalidation interval and opened again when the file has been replaced or modified.
+    struct executable_cache
+    {
+        explicit executable_cache(std::chrono::steady_clock::duration revalidation_interval = std::chrono::seconds(1))
+            : m_revalidation_interval(revalidation_interval)
+        {
+        }
+
+        /// @param name a file name to be searched in PATH or a path containing a slash
+        SILICIUM_USE_RESULT
+        Si::error_or<std::shared_ptr<executable_handle const>> resolve(Si::noexcept_string const &name)
+        {
+            auto const now = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            entry &cached = m_entries[name];
+            if (cached.handle)
+            {
+                if ((now - cached.validated) < m_revalidation_interval)
+                {
+                    return cached.handle;
+                }
+                if (!cached.handle->is_stale())
+                {
+                    cached.validated = now;
+                    return cached.handle;
+                }
+            }
+            Si::error_or<absolute_path> found = find_executable(name);
+            if (found.is_error())
+            {
+                m_entries.erase(name);
+                return found.error();
+            }
+            Si::error_or<executable_handle> opened = executable_handle::open(found.move_value());
+            if (opened.is_error())
+            {
+                m_entries.erase(name);
+                return opened.error();
+            }
+            // launches that are still using the previous handle keep it alive
+            cached.handle = std::make_shared<executable_handle const>(opened.move_value());
+            cached.validated = now;
+            return cached.handle;
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.clear();
+        }
+
+    private:
+        struct entry
+        {
+            std::shared_ptr<executable_handle const> handle;
+            std::chrono::steady_clock::time_point validated;
+        };
+
+        std::chrono::steady_clock::duration m_revalidation_interval;
+        std::mutex m_mutex;
+        std::map<Si::noexcept_string, entry> m_entries;
+    };
+
+    /// resolves the command through the cache and runs it
+    SILICIUM_USE_RESULT
+    inline Si::error_or<int> run_process(executable_cache &executables, Si::noexcept_string const &command,
+                                         process_parameters parameters)
+    {
+        Si::error_or<std::shared_ptr<executable_handle const>> const resolved = executables.resolve(command);
+        if (resolved.is_error())
+        {
+            return resolved.error();
+        }
+        resolved.get()->prepare(parameters);
+        return run_process(parameters);
+    }
+}
+#endif
+
+#endif
@@ -5,6 +5,7 @@
 #include <silicium/error_handler.hpp>
 #include <silicium/identity.hpp>
 #include <silicium/read.hpp>
+#include <ventura/detail/read_loop.hpp>
 #include <ventura/file_size.hpp>
 #include <ventura/open.hpp>
 #include <ventura/run_process.hpp>
@@ -415,23 +416,48 @@ namespace ventura
 #endif
     }
 
+    /// Files without a size or with a reported size of zero (pipes, procfs) are read until their end. Throws when the
+    /// file is modified while it is being read.
     inline Si::error_or<std::vector<char>> read_file(Si::native_file_descriptor file)
     {
         std::vector<char> content;
-        boost::uint64_t size =
-            ventura::file_size(file).get().or_throw([]
-                                                    {
-                                                        throw std::runtime_error("Expected file to have a size");
-                                                    });
+        Si::error_or<detail::file_version> const version = detail::get_file_version(file);
+        if (version.is_error())
+        {
+            return version.error();
+        }
+        if (!version.get().regular || (version.get().size == 0))
+        {
+            Si::error_or<bool> const complete =
+                detail::read_until_end(file, content, (std::numeric_limits<std::size_t>::max)());
+            if (complete.is_error())
+            {
+                return complete.error();
+            }
+            if (!complete.get())
+            {
+                throw std::bad_alloc();
+            }
+            return Si::error_or<std::vector<char>>(std::move(content));
+        }
+        boost::uint64_t const size = version.get().size;
         if (size > content.max_size())
         {
             throw std::bad_alloc();
         }
         content.resize(static_cast<std::size_t>(size));
-        if (Si::read(file, Si::make_memory_range(content)).get() != size)
+        Si::error_or<Si::optional<std::size_t>> const read =
+            detail::read_known_size(file, content.data(), content.size(), version.get());
+        if (read.is_error())
+        {
+            return read.error();
+        }
+        if (!read.get())
         {
-            throw std::runtime_error(boost::str(boost::format("Could not read %1% bytes from a file") % size));
+            throw std::runtime_error(
+                boost::str(boost::format("The file of %1% bytes was modified while it was being read") % size));
         }
+        content.resize(*read.get());
         return Si::error_or<std::vector<char>>(std::move(content));
     }
 
@@ -0,0 +1,371 @@
+#ifndef VENTURA_JOBSERVER_HPP
+#define VENTURA_JOBSERVER_HPP
+
+#include <ventura/run_process.hpp>
+#include <boost/lexical_cast.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// the Windows flavour of the jobserver (a named semaphore) is not supported yet
+#if VENTURA_HAS_RUN_PROCESS && !defined(_WIN32)
+#define VENTURA_HAS_JOBSERVER 1
+#else
+#define VENTURA_HAS_JOBSERVER 0
+#endif
+
+#if VENTURA_HAS_JOBSERVER
+namespace ventura
+{
+    namespace detail
+    {
+        struct jobserver_state
+        {
+            Si::native_file_descriptor read;
+            Si::native_file_descriptor write;
+
+            /// set when the descriptors are not borrowed from the parent make
+            Si::file_handle owned_read;
+            Si::file_handle owned_write;
+
+            std::mutex mutex;
+
+            /// Every participant of a jobserver owns one job slot without holding a token for it.
+            bool implicit_token_available;
+
+            jobserver_state(Si::native_file_descriptor read, Si::native_file_descriptor write)
+                : read(read)
+                , write(write)
+                , implicit_token_available(true)
+            {
+            }
+        };
+
+        inline bool is_open_file_descriptor(Si::native_file_descriptor file)
+        {
+            return fcntl(file, F_GETFD) >= 0;
+        }
+    }
+
+    /// A slot of the shared parallelism budget. The destructor hands the slot back to the jobserver.
+    struct jobserver_token
+    {
+        jobserver_token() BOOST_NOEXCEPT : m_value(0), m_is_implicit(false)
+        {
+        }
+
+        jobserver_token(std::shared_ptr<detail::jobserver_state> state, char value, bool is_implicit) BOOST_NOEXCEPT
+            : m_state(std::move(state)),
+              m_value(value),
+              m_is_implicit(is_implicit)
+        {
+        }
+
+        jobserver_token(jobserver_token &&other) BOOST_NOEXCEPT : m_state(std::move(other.m_state)),
+                                                                  m_value(other.m_value),
+                                                                  m_is_implicit(other.m_is_implicit)
+        {
+        }
+
+        jobserver_token &operator=(jobserver_token &&other) BOOST_NOEXCEPT
+        {
+            release();
+            m_state = std::move(other.m_state);
+            m_value = other.m_value;
+            m_is_implicit = other.m_is_implicit;
+            return *this;
+        }
+
+        ~jobserver_token() BOOST_NOEXCEPT
+        {
+            release();
+        }
+
+        void release() BOOST_NOEXCEPT
+        {
+            if (!m_state)
+            {
+                return;
+            }
+            std::shared_ptr<detail::jobserver_state> const state = std::move(m_state);
+            if (m_is_implicit)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->implicit_token_available = true;
+                return;
+            }
+            for (;;)
+            {
+                ssize_t const written = ::write(state->write, &m_value, 1);
+                if ((written < 0) && (errno == EINTR))
+                {
+                    continue;
+                }
+
+                // If writing fails, the token is lost and the whole build gets less parallel. There is no one to
+                // report the error to.
+                break;
+            }
+        }
+
+    private:
+        std::shared_ptr<detail::jobserver_state> m_state;
+        char m_value;
+        bool m_is_implicit;
+
+        SILICIUM_DELETED_FUNCTION(jobserver_token(jobserver_token const &))
+        SILICIUM_DELETED_FUNCTION(jobserver_token &operator=(jobserver_token const &))
+    };
+
+    /// A participant in the GNU make jobserver protocol. Acquire a token before launching each job.
+    struct jobserver_client
+    {
+        jobserver_client() BOOST_NOEXCEPT
+        {
+        }
+
+        explicit jobserver_client(std::shared_ptr<detail::jobserver_state> state) BOOST_NOEXCEPT
+            : m_state(std::move(state))
+        {
+        }
+
+        /// Finds the jobserver in a MAKEFLAGS value. Understands --jobserver-auth=R,W, --jobserver-fds=R,W (make
+        /// before 4.2) and --jobserver-auth=fifo:PATH (make 4.4). Returns none if there is no jobserver or if its
+        /// file descriptors were not inherited (a recipe without the + prefix).
+        SILICIUM_USE_RESULT
+        static Si::error_or<Si::optional<jobserver_client>> from_makeflags(char const *makeflags)
+        {
+            char const *value = nullptr;
+            for (char const *option : {"--jobserver-auth=", "--jobserver-fds="})
+            {
+                // like make, use the last occurrence
+                for (char const *found = std::strstr(makeflags, option); found;
+                     found = std::strstr(found + 1, option))
+                {
+                    char const *const candidate = found + std::strlen(option);
+                    if (!value || (candidate > value))
+                    {
+                        value = candidate;
+                    }
+                }
+            }
+            if (!value)
+            {
+                return Si::optional<jobserver_client>();
+            }
+            std::string const argument(value, std::find(value, value + std::strlen(value), ' '));
+
+            char const fifo_prefix[] = "fifo:";
+            if (argument.compare(0, sizeof(fifo_prefix) - 1, fifo_prefix) == 0)
+            {
+                std::string const fifo = argument.substr(sizeof(fifo_prefix) - 1);
+                Si::native_file_descriptor const opened = ::open(fifo.c_str(), O_RDWR | O_CLOEXEC);
+                if (opened < 0)
+                {
+                    return Si::get_last_error();
+                }
+                auto state = std::make_shared<detail::jobserver_state>(opened, opened);
+                state->owned_read = Si::file_handle(opened);
+                return Si::optional<jobserver_client>(jobserver_client(std::move(state)));
+            }
+
+            std::size_t const comma = argument.find(',');
+            if (comma == std::string::npos)
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::invalid_argument);
+            }
+            Si::native_file_descriptor read = -1;
+            Si::native_file_descriptor write = -1;
+            try
+            {
+                read = boost::lexical_cast<Si::native_file_descriptor>(argument.substr(0, comma));
+                write = boost::lexical_cast<Si::native_file_descriptor>(argument.substr(comma + 1));
+            }
+            catch (boost::bad_lexical_cast const &)
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::invalid_argument);
+            }
+            if ((read < 0) || (write < 0) || !detail::is_open_file_descriptor(read) ||
+                !detail::is_open_file_descriptor(write))
+            {
+                return Si::optional<jobserver_client>();
+            }
+            return Si::optional<jobserver_client>(
+                jobserver_client(std::make_shared<detail::jobserver_state>(read, write)));
+        }
+
+        /// Looks for the jobserver of a parent make in the MAKEFLAGS environment variable.
+        SILICIUM_USE_RESULT
+        static Si::error_or<Si::optional<jobserver_client>> from_environment()
+        {
+            char const *const makeflags = std::getenv("MAKEFLAGS");
+            if (!makeflags)
+            {
+                return Si::optional<jobserver_client>();
+            }
+            return from_makeflags(makeflags);
+        }
+
+        /// Blocks until a job slot is available.
+        SILICIUM_USE_RESULT
+        Si::error_or<jobserver_token> acquire()
+        {
+            assert(m_state);
+            {
+                std::lock_guard<std::mutex> lock(m_state->mutex);
+                if (m_state->implicit_token_available)
+                {
+                    m_state->implicit_token_available = false;
+                    return jobserver_token(m_state, 0, true);
+                }
+            }
+            for (;;)
+            {
+                char value = 0;
+                ssize_t const read = ::read(m_state->read, &value, 1);
+                if (read == 1)
+                {
+                    return jobserver_token(m_state, value, false);
+                }
+                if (read == 0)
+                {
+                    // every writer is gone, so no token will ever come back
+                    return boost::system::errc::make_error_code(boost::system::errc::broken_pipe);
+                }
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+                {
+                    // the parent may have made the pipe non-blocking
+                    pollfd readable = {};
+                    readable.fd = m_state->read;
+                    readable.events = POLLIN;
+                    if ((poll(&readable, 1, -1) < 0) && (errno != EINTR))
+                    {
+                        return Si::get_last_error();
+                    }
+                    continue;
+                }
+                return Si::get_last_error();
+            }
+        }
+
+        /// Lets a child that understands the jobserver protocol share the budget. MAKEFLAGS is inherited through
+        /// the environment.
+        void share_with(process_parameters &parameters) const
+        {
+            assert(m_state);
+            parameters.inherited_file_descriptors.emplace_back(m_state->read);
+            if (m_state->write != m_state->read)
+            {
+                parameters.inherited_file_descriptors.emplace_back(m_state->write);
+            }
+        }
+
+    private:
+        std::shared_ptr<detail::jobserver_state> m_state;
+    };
+
+    /// Owns a jobserver with a fixed number of job slots, like the top-level make -jN does.
+    struct jobserver_server
+    {
+        jobserver_server() BOOST_NOEXCEPT
+        {
+        }
+
+        SILICIUM_USE_RESULT
+        static Si::error_or<jobserver_server> create(std::size_t jobs)
+        {
+            assert(jobs >= 1);
+            Si::error_or<Si::pipe> created = Si::make_pipe();
+            if (created.is_error())
+            {
+                return created.error();
+            }
+            Si::pipe tokens = created.move_value();
+            auto state = std::make_shared<detail::jobserver_state>(tokens.read.handle, tokens.write.handle);
+            state->owned_read = std::move(tokens.read);
+            state->owned_write = std::move(tokens.write);
+
+            // the implicit slot of the server is not represented in the pipe
+            std::vector<char> const initial_tokens(jobs - 1, '+');
+            std::size_t written = 0;
+            while (written < initial_tokens.size())
+            {
+                ssize_t const rc =
+                    ::write(state->write, initial_tokens.data() + written, initial_tokens.size() - written);
+                if (rc < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return Si::get_last_error();
+                }
+                written += static_cast<std::size_t>(rc);
+            }
+
+            std::string const descriptors =
+                boost::lexical_cast<std::string>(state->read) + "," + boost::lexical_cast<std::string>(state->write);
+            auto makeflags = std::make_shared<Si::noexcept_string>(
+                (" -j" + boost::lexical_cast<std::string>(jobs) + " --jobserver-fds=" + descriptors +
+                 " --jobserver-auth=" + descriptors)
+                    .c_str());
+            jobserver_server result;
+            result.m_state = std::move(state);
+            result.m_makeflags = std::move(makeflags);
+            return std::move(result);
+        }
+
+        /// lets this process take part in its own jobserver
+        SILICIUM_USE_RESULT
+        jobserver_client client() const
+        {
+            return jobserver_client(m_state);
+        }
+
+        SILICIUM_USE_RESULT
+        Si::noexcept_string const &makeflags() const
+        {
+            assert(m_makeflags);
+            return *m_makeflags;
+        }
+
+        /// Passes the token pipe to the child and sets MAKEFLAGS for it. The server has to outlive the child's
+        /// launch because the environment entry points into the server.
+        void share_with(process_parameters &parameters) const
+        {
+            client().share_with(parameters);
+            parameters.additional_environment.emplace_back("MAKEFLAGS", m_makeflags->c_str());
+        }
+
+    private:
+        std::shared_ptr<detail::jobserver_state> m_state;
+        std::shared_ptr<Si::noexcept_string const> m_makeflags;
+    };
+
+    /// Waits for a job slot, runs the process and gives the slot back.
+    SILICIUM_USE_RESULT
+    inline Si::error_or<int> run_process(jobserver_client &jobs, process_parameters const &parameters)
+    {
+        Si::error_or<jobserver_token> token = jobs.acquire();
+        if (token.is_error())
+        {
+            return token.error();
+        }
+        return run_process(parameters);
+    }
+}
+#endif
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef VENTURA_MAP_FILE_HPP
+#define VENTURA_MAP_FILE_HPP
+
+#include <ventura/file_size.hpp>
+#include <ventura/open.hpp>
+#include <silicium/error_or.hpp>
+#include <silicium/memory_range.hpp>
+#include <boost/cstdint.hpp>
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+#define VENTURA_HAS_MAP_FILE 1
+#else
+#define VENTURA_HAS_MAP_FILE 0
+#endif
+
+namespace ventura
+{
+#if VENTURA_HAS_MAP_FILE
+    /// how the content of a mapped_file is going to be read (madvise)
+    enum class mapping_advice
+    {
+        normal,
+
+        /// from the beginning to the end, so pages can be read ahead aggressively and dropped soon after
+        sequential,
+
+        /// in no particular order, so reading ahead would be a waste
+        random,
+
+        /// soon and completely, so the whole file is read into the page cache in the background
+        will_need
+    };
+
+    /// A read-only view of the content of a file that is mapped into memory. Nothing is copied, and the pages are
+    /// shared with the page cache and every other process that maps the same file. The view stays valid when the file
+    /// descriptor is closed. Truncating the file while it is mapped makes the access to the cut off pages fail with
+    /// SIGBUS, so this is for files that are not modified while they are being read.
+    struct mapped_file
+    {
+        mapped_file() BOOST_NOEXCEPT : m_data(nullptr), m_size(0)
+        {
+        }
+
+        mapped_file(char const *data, std::size_t size) BOOST_NOEXCEPT : m_data(data), m_size(size)
+        {
+        }
+
+        mapped_file(mapped_file &&other) BOOST_NOEXCEPT : m_data(other.m_data), m_size(other.m_size)
+        {
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+
+        mapped_file &operator=(mapped_file &&other) BOOST_NOEXCEPT
+        {
+            if (this != &other)
+            {
+                unmap();
+                m_data = other.m_data;
+                m_size = other.m_size;
+                other.m_data = nullptr;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+
+        ~mapped_file() BOOST_NOEXCEPT
+        {
+            unmap();
+        }
+
+        /// nullptr for an empty file
+        char const *data() const BOOST_NOEXCEPT
+        {
+            return m_data;
+        }
+
+        std::size_t size() const BOOST_NOEXCEPT
+        {
+            return m_size;
+        }
+
+        Si::memory_range content() const BOOST_NOEXCEPT
+        {
+            return Si::make_memory_range(m_data, m_data + m_size);
+        }
+
+        /// passes another hint for the whole view to the system
+        boost::system::error_code advise(mapping_advice advice) const
+        {
+            if ((m_size == 0) || (madvise(const_cast<char *>(m_data), m_size, to_madvise(advice)) == 0))
+            {
+                return boost::system::error_code();
+            }
+            return Si::get_last_error();
+        }
+
+        static int to_madvise(mapping_advice advice) BOOST_NOEXCEPT
+        {
+            switch (advice)
+            {
+            case mapping_advice::normal:
+                return MADV_NORMAL;
+
+            case mapping_advice::sequential:
+                return MADV_SEQUENTIAL;
+
+            case mapping_advice::random:
+                return MADV_RANDOM;
+
+            case mapping_advice::will_need:
+                return MADV_WILLNEED;
+            }
+            SILICIUM_UNREACHABLE();
+        }
+
+    private:
+        char const *m_data;
+        std::size_t m_size;
+
+        void unmap() BOOST_NOEXCEPT
+        {
+            if (m_data)
+            {
+                munmap(const_cast<char *>(m_data), m_size);
+            }
+        }
+
+        SILICIUM_DELETED_FUNCTION(mapped_file(mapped_file const &))
+        SILICIUM_DELETED_FUNCTION(mapped_file &operator=(mapped_file const &))
+    };
+
+    namespace detail
+    {
+        /// the size of the pages of the transparent huge page support of Linux on most architectures
+        std::size_t const huge_page_size = 2 * 1024 * 1024;
+
+        /// Maps the file at an address that is a multiple of huge_page_size. The system can only use huge pages for a
+        /// mapping that is aligned like that. An anonymous area that is large enough for the alignment is reserved
+        /// first, and the file is mapped over the aligned part of it.
+        inline void *map_huge_page_aligned(Si::native_file_descriptor file, std::size_t size)
+        {
+            if (size > ((std::numeric_limits<std::size_t>::max)() - huge_page_size))
+            {
+                errno = ENOMEM;
+                return MAP_FAILED;
+            }
+            std::size_t const reserved_size = size + huge_page_size;
+            void *const reserved = mmap(nullptr, reserved_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (reserved == MAP_FAILED)
+            {
+                return MAP_FAILED;
+            }
+            std::uintptr_t const reserved_begin = reinterpret_cast<std::uintptr_t>(reserved);
+            std::uintptr_t const aligned_begin = (reserved_begin + huge_page_size - 1) & ~(huge_page_size - 1);
+            void *const mapping = mmap(reinterpret_cast<void *>(aligned_begin), size, PROT_READ,
+                                       MAP_PRIVATE | MAP_FIXED, file, 0);
+            if (mapping == MAP_FAILED)
+            {
+                int const error = errno;
+                munmap(reserved, reserved_size);
+                errno = error;
+                return MAP_FAILED;
+            }
+            // return the parts of the reservation before and after the file
+            std::size_t const page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            std::uintptr_t const mapping_end = aligned_begin + ((size + page_size - 1) / page_size * page_size);
+            std::uintptr_t const reserved_end = reserved_begin + reserved_size;
+            if (aligned_begin > reserved_begin)
+            {
+                munmap(reserved, aligned_begin - reserved_begin);
+            }
+            if (reserved_end > mapping_end)
+            {
+                munmap(reinterpret_cast<void *>(mapping_end), reserved_end - mapping_end);
+            }
+#ifdef MADV_HUGEPAGE
+            // only a hint, which needs CONFIG_READ_ONLY_THP_FOR_FS for files
+            madvise(mapping, size, MADV_HUGEPAGE);
+#endif
+            return mapping;
+        }
+    }
+
+    /// Maps the whole content of a regular file for reading. This is the zero-copy alternative to read_file for large
+    /// inputs: mapping is instant and the content is paged in on access.
+    /// @param huge_page_alignment aligns the mapping so that Linux can use transparent huge pages for it, which means
+    /// fewer TLB misses for large files
+    SILICIUM_USE_RESULT
+    inline Si::error_or<mapped_file> map_file(Si::native_file_descriptor file,
+                                              mapping_advice advice = mapping_advice::normal,
+                                              bool huge_page_alignment = false)
+    {
+        Si::error_or<Si::optional<boost::uint64_t>> const size = file_size(file);
+        if (size.is_error())
+        {
+            return size.error();
+        }
+        if (!size.get())
+        {
+            return boost::system::errc::make_error_code(boost::system::errc::invalid_seek);
+        }
+        if (*size.get() == 0)
+        {
+            // mmap refuses empty mappings
+            return mapped_file();
+        }
+        if (*size.get() > (std::numeric_limits<std::size_t>::max)())
+        {
+            return boost::system::errc::make_error_code(boost::system::errc::file_too_large);
+        }
+        std::size_t const length = static_cast<std::size_t>(*size.get());
+        void *const mapping = huge_page_alignment ? detail::map_huge_page_aligned(file, length)
+                                                  : mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping == MAP_FAILED)
+        {
+            return Si::get_last_error();
+        }
+        mapped_file result(static_cast<char const *>(mapping), length);
+        if (advice != mapping_advice::normal)
+        {
+            // the mapping is usable even if the hint is not
+            boost::system::error_code const ignored = result.advise(advice);
+            (void)ignored;
+        }
+        return std::move(result);
+    }
+
+    SILICIUM_USE_RESULT
+    inline Si::error_or<mapped_file> map_file(Si::native_path_string name,
+                                              mapping_advice advice = mapping_advice::normal,
+                                              bool huge_page_alignment = false)
+    {
+        Si::error_or<Si::file_handle> const file = open_reading(name);
+        if (file.is_error())
+        {
+            return file.error();
+        }
+        return map_file(file.get().handle, advice, huge_page_alignment);
+    }
+#endif
+}
+
+#endif
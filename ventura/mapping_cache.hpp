@@ -0,0 +1,163 @@
+#ifndef VENTURA_MAPPING_CACHE_HPP
+#define VENTURA_MAPPING_CACHE_HPP
+
+#include <ventura/absolute_path.hpp>
+#include <ventura/detail/file_identity.hpp>
+#include <ventura/map_file.hpp>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#if VENTURA_HAS_MAP_FILE
+#define VENTURA_HAS_MAPPING_CACHE 1
+#else
+#define VENTURA_HAS_MAPPING_CACHE 0
+#endif
+
+#if VENTURA_HAS_MAPPING_CACHE
+namespace ventura
+{
+    /// Shares read-only mappings of files between all threads of a process. A lookup compares the device, inode, size
+    /// and modification time of the file with the cached mapping and maps the file again when it has been replaced or
+    /// modified. The mappings held by the cache are limited to a budget of bytes, and the least recently used ones are
+    /// dropped first. Views that are still in use stay mapped until they are released. System calls are made without
+    /// holding the lock, so lookups of different threads block each other only for the bookkeeping.
+    struct mapping_cache
+    {
+        typedef std::shared_ptr<mapped_file const> view;
+
+        explicit mapping_cache(std::size_t budget_bytes)
+            : m_budget(budget_bytes)
+            , m_mapped_bytes(0)
+        {
+        }
+
+        /// @param advice is only applied when the file has to be mapped
+        SILICIUM_USE_RESULT
+        Si::error_or<view> get(absolute_path const &path, mapping_advice advice = mapping_advice::normal)
+        {
+            struct stat status;
+            if (stat(path.c_str(), &status) < 0)
+            {
+                return Si::get_last_error();
+            }
+            detail::file_identity const current = detail::make_file_identity(status);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto const found = m_entries.find(path);
+                if (found != m_entries.end())
+                {
+                    if (found->second.identity == current)
+                    {
+                        m_recently_used.splice(m_recently_used.begin(), m_recently_used, found->second.use);
+                        return found->second.mapped;
+                    }
+                    forget(found);
+                }
+            }
+
+            Si::error_or<Si::file_handle> const file = open_reading(Si::native_path_string(path.c_str()));
+            if (file.is_error())
+            {
+                return file.error();
+            }
+            // the identity of what is actually mapped in case the file has been replaced since the stat
+            if (fstat(file.get().handle, &status) < 0)
+            {
+                return Si::get_last_error();
+            }
+            detail::file_identity const opened = detail::make_file_identity(status);
+            Si::error_or<mapped_file> mapped = map_file(file.get().handle, advice);
+            if (mapped.is_error())
+            {
+                return mapped.error();
+            }
+            view const result = std::make_shared<mapped_file const>(mapped.move_value());
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto const found = m_entries.find(path);
+            if (found != m_entries.end())
+            {
+                if (found->second.identity == opened)
+                {
+                    // another thread has mapped the same file in the meantime
+                    m_recently_used.splice(m_recently_used.begin(), m_recently_used, found->second.use);
+                    return found->second.mapped;
+                }
+                forget(found);
+            }
+            if (result->size() > m_budget)
+            {
+                return result;
+            }
+            while ((m_budget - m_mapped_bytes) < result->size())
+            {
+                assert(!m_recently_used.empty());
+                forget(m_entries.find(m_recently_used.back()));
+            }
+            m_recently_used.push_front(path);
+            entry &inserted = m_entries[path];
+            inserted.mapped = result;
+            inserted.identity = opened;
+            inserted.use = m_recently_used.begin();
+            m_mapped_bytes += result->size();
+            return result;
+        }
+
+        /// the number of bytes of the mappings that are currently held by the cache
+        std::size_t mapped_bytes() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_mapped_bytes;
+        }
+
+        std::size_t size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_entries.size();
+        }
+
+        void clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_recently_used.clear();
+            m_entries.clear();
+            m_mapped_bytes = 0;
+        }
+
+    private:
+        struct entry
+        {
+            view mapped;
+            detail::file_identity identity;
+            std::list<absolute_path>::iterator use;
+        };
+
+        typedef std::map<absolute_path, entry> entry_map;
+
+        std::size_t const m_budget;
+        mutable std::mutex m_mutex;
+        entry_map m_entries;
+
+        /// the most recently used entry comes first
+        std::list<absolute_path> m_recently_used;
+
+        std::size_t m_mapped_bytes;
+
+        void forget(entry_map::iterator const found)
+        {
+            m_mapped_bytes -= found->second.mapped->size();
+            m_recently_used.erase(found->second.use);
+            m_entries.erase(found);
+        }
+    };
+}
+#endif
+
+#endif
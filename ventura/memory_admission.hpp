@@ -0,0 +1,298 @@
+#ifndef VENTURA_MEMORY_ADMISSION_HPP
+#define VENTURA_MEMORY_ADMISSION_HPP
+
+#include <ventura/run_process.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#if VENTURA_HAS_RUN_PROCESS && !defined(_WIN32)
+#define VENTURA_HAS_MEMORY_ADMISSION 1
+#else
+#define VENTURA_HAS_MEMORY_ADMISSION 0
+#endif
+
+#if VENTURA_HAS_MEMORY_ADMISSION
+namespace ventura
+{
+    /// MemAvailable from /proc/meminfo, none where that is not available
+    inline Si::optional<boost::uint64_t> read_available_memory()
+    {
+        std::ifstream meminfo("/proc/meminfo");
+        std::string line;
+        while (std::getline(meminfo, line))
+        {
+            std::istringstream fields(line);
+            std::string key;
+            boost::uint64_t kilobytes = 0;
+            if ((fields >> key >> kilobytes) && (key == "MemAvailable:"))
+            {
+                return kilobytes * 1024u;
+            }
+        }
+        return Si::none;
+    }
+
+    /// The share of the last ten seconds in which some tasks were stalled on memory, in percent (the "some avg10"
+    /// value from /proc/pressure/memory). None if the kernel does not provide pressure stall information.
+    inline Si::optional<double> read_memory_pressure()
+    {
+        std::ifstream pressure("/proc/pressure/memory");
+        std::string line;
+        while (std::getline(pressure, line))
+        {
+            char const prefix[] = "some avg10=";
+            if (line.compare(0, sizeof(prefix) - 1, prefix) != 0)
+            {
+                continue;
+            }
+            std::istringstream value(line.substr(sizeof(prefix) - 1));
+            double percent = 0;
+            if (value >> percent)
+            {
+                return percent;
+            }
+        }
+        return Si::none;
+    }
+
+    namespace detail
+    {
+        /// what the kernel reports about the memory of the whole machine
+        struct system_memory_state
+        {
+            Si::optional<boost::uint64_t> available;
+            Si::optional<double> pressure;
+        };
+
+        inline system_memory_state read_system_memory_state()
+        {
+            system_memory_state result;
+            result.available = read_available_memory();
+            result.pressure = read_memory_pressure();
+            return result;
+        }
+    }
+
+    struct memory_admission_options
+    {
+        /// upper bound for the sum of the predicted peak memory of all admitted commands
+        boost::uint64_t budget_bytes;
+
+        /// assumed peak for commands that have never been measured
+        boost::uint64_t default_estimate_bytes;
+
+        /// no new command is admitted while the memory pressure is above this (see read_memory_pressure)
+        double maximum_pressure;
+
+        /// how often the system state is polled while a command is held back
+        std::chrono::milliseconds poll_interval;
+
+        explicit memory_admission_options(boost::uint64_t budget_bytes)
+            : budget_bytes(budget_bytes)
+            , default_estimate_bytes(256u * 1024u * 1024u)
+            , maximum_pressure(10.0)
+            , poll_interval(250)
+        {
+        }
+    };
+
+    struct memory_admission_controller;
+
+    /// The memory an admitted command is expected to use. The destructor gives it back.
+    struct memory_reservation
+    {
+        memory_reservation() BOOST_NOEXCEPT : m_controller(nullptr), m_bytes(0)
+        {
+        }
+
+        memory_reservation(memory_admission_controller &controller, boost::uint64_t bytes) BOOST_NOEXCEPT
+            : m_controller(&controller),
+              m_bytes(bytes)
+        {
+        }
+
+        memory_reservation(memory_reservation &&other) BOOST_NOEXCEPT : m_controller(other.m_controller),
+                                                                        m_bytes(other.m_bytes)
+        {
+            other.m_controller = nullptr;
+        }
+
+        memory_reservation &operator=(memory_reservation &&other) BOOST_NOEXCEPT
+        {
+            release();
+            m_controller = Si::exchange(other.m_controller, nullptr);
+            m_bytes = other.m_bytes;
+            return *this;
+        }
+
+        ~memory_reservation() BOOST_NOEXCEPT
+        {
+            release();
+        }
+
+        boost::uint64_t bytes() const BOOST_NOEXCEPT
+        {
+            return m_bytes;
+        }
+
+        inline void release() BOOST_NOEXCEPT;
+
+    private:
+        memory_admission_controller *m_controller;
+        boost::uint64_t m_bytes;
+
+        SILICIUM_DELETED_FUNCTION(memory_reservation(memory_reservation const &))
+        SILICIUM_DELETED_FUNCTION(memory_reservation &operator=(memory_reservation const &))
+    };
+
+    /// Holds back new processes while their predicted memory use would exceed a budget, the free memory of the
+    /// machine or while the machine is already under memory pressure. The prediction for a command is the
+    /// largest peak resident set size that was recorded for it.
+    struct memory_admission_controller
+    {
+        explicit memory_admission_controller(memory_admission_options options)
+            : m_options(options)
+            , m_reserved(0)
+            , m_admitted(0)
+        {
+        }
+
+        SILICIUM_USE_RESULT
+        boost::uint64_t predict(Si::noexcept_string const &command) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return predict_locked(command);
+        }
+
+        /// remembers the measured peak of a command for future predictions
+        void record(Si::noexcept_string const &command, boost::uint64_t peak_resident_bytes)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            boost::uint64_t &peak = m_peaks[command];
+            peak = (std::max)(peak, peak_resident_bytes);
+        }
+
+        /// Blocks until the command may be launched. When nothing else is admitted, the command is admitted
+        /// regardless of the limits so that progress is always possible.
+        SILICIUM_USE_RESULT
+        memory_reservation admit(Si::noexcept_string const &command)
+        {
+            for (;;)
+            {
+                // read without the lock so that record and release do not wait for the files in /proc
+                detail::system_memory_state const system = detail::read_system_memory_state();
+                std::unique_lock<std::mutex> lock(m_mutex);
+                boost::uint64_t const predicted = predict_locked(command);
+                if (may_admit(predicted, system))
+                {
+                    m_reserved += predicted;
+                    ++m_admitted;
+                    return memory_reservation(*this, predicted);
+                }
+
+                // memory can also be freed by processes we do not know about, so the state is polled
+                m_released.wait_for(lock, m_options.poll_interval);
+            }
+        }
+
+        SILICIUM_USE_RESULT
+        Si::optional<memory_reservation> try_admit(Si::noexcept_string const &command)
+        {
+            detail::system_memory_state const system = detail::read_system_memory_state();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            boost::uint64_t const predicted = predict_locked(command);
+            if (!may_admit(predicted, system))
+            {
+                return Si::none;
+            }
+            m_reserved += predicted;
+            ++m_admitted;
+            return memory_reservation(*this, predicted);
+        }
+
+    private:
+        friend struct memory_reservation;
+
+        memory_admission_options m_options;
+        mutable std::mutex m_mutex;
+        std::condition_variable m_released;
+        std::map<Si::noexcept_string, boost::uint64_t> m_peaks;
+        boost::uint64_t m_reserved;
+        std::size_t m_admitted;
+
+        boost::uint64_t predict_locked(Si::noexcept_string const &command) const
+        {
+            auto const found = m_peaks.find(command);
+            return (found == m_peaks.end()) ? m_options.default_estimate_bytes : found->second;
+        }
+
+        bool may_admit(boost::uint64_t predicted, detail::system_memory_state const &system) const
+        {
+            if (m_admitted == 0)
+            {
+                return true;
+            }
+            if ((m_reserved + predicted) > m_options.budget_bytes)
+            {
+                return false;
+            }
+            // The commands admitted just before have not grown to their peak yet, so what they are going to use is
+            // not available to this one. Otherwise a burst of large commands would all pass at the same moment.
+            if (system.available &&
+                (predicted > (*system.available - (std::min)(*system.available, m_reserved))))
+            {
+                return false;
+            }
+            if (system.pressure && (*system.pressure > m_options.maximum_pressure))
+            {
+                return false;
+            }
+            return true;
+        }
+
+        void release(boost::uint64_t bytes) BOOST_NOEXCEPT
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                assert(m_reserved >= bytes);
+                assert(m_admitted > 0);
+                m_reserved -= bytes;
+                --m_admitted;
+            }
+            m_released.notify_all();
+        }
+    };
+
+    inline void memory_reservation::release() BOOST_NOEXCEPT
+    {
+        if (!m_controller)
+        {
+            return;
+        }
+        Si::exchange(m_controller, nullptr)->release(m_bytes);
+    }
+
+    /// Waits for admission, runs the process and records its peak memory for the next prediction.
+    SILICIUM_USE_RESULT
+    inline Si::error_or<int> run_process(memory_admission_controller &memory, Si::noexcept_string const &command,
+                                         process_parameters parameters)
+    {
+        memory_reservation const reservation = memory.admit(command);
+        process_resource_usage usage;
+        parameters.resource_usage = &usage;
+        Si::error_or<int> const result = run_process(parameters);
+        if (!result.is_error())
+        {
+            memory.record(command, usage.peak_resident_bytes);
+        }
+        return result;
+    }
+}
+#endif
+
+#endif
@@ -3,6 +3,8 @@
 
 #ifdef _WIN32
 #include <ventura/win32/open.hpp>
+// FILE_FLAG_NO_BUFFERING is not supported yet
+#define VENTURA_HAS_DIRECT_IO 0
 #else
 #include <ventura/posix/open.hpp>
 #endif
@@ -10,6 +10,12 @@
 #include <fcntl.h>
 #endif
 
+#if defined(O_DIRECT) || defined(__APPLE__)
+#define VENTURA_HAS_DIRECT_IO 1
+#else
+#define VENTURA_HAS_DIRECT_IO 0
+#endif
+
 namespace ventura
 {
     inline Si::error_or<Si::file_handle> open_reading(Si::native_path_string name)
@@ -49,6 +55,76 @@ namespace ventura
         return Si::file_handle(fd);
     }
 
+    /// Like overwrite_file, but every write returns only after the data is on the storage device (O_DSYNC).
+    inline Si::error_or<Si::file_handle> open_synchronous_writing(Si::native_path_string name)
+    {
+        Si::native_file_descriptor const fd =
+            ::open(name.c_str(), O_WRONLY | O_TRUNC | O_CREAT | O_DSYNC, S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+        if (fd < 0)
+        {
+            return Si::get_last_error();
+        }
+        return Si::file_handle(fd);
+    }
+
+#if VENTURA_HAS_DIRECT_IO
+    namespace detail
+    {
+        inline Si::error_or<Si::file_handle> open_direct(Si::native_path_string name, int flags)
+        {
+#ifdef __APPLE__
+            Si::native_file_descriptor const fd =
+                ::open(name.c_str(), flags, S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+#else
+            Si::native_file_descriptor const fd =
+                ::open(name.c_str(), flags | O_DIRECT, S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+#endif
+            if (fd < 0)
+            {
+                return Si::get_last_error();
+            }
+            Si::file_handle file(fd);
+#ifdef __APPLE__
+            // OS X has no O_DIRECT, but it can bypass the cache for a descriptor
+            if (fcntl(file.handle, F_NOCACHE, 1) < 0)
+            {
+                return Si::get_last_error();
+            }
+#endif
+            return std::move(file);
+        }
+    }
+
+    /// Like open_reading, but the data bypasses the page cache (O_DIRECT). Offsets, sizes and buffer addresses of
+    /// reads have to be aligned to the logical block size of the file system. Some file systems like tmpfs refuse
+    /// O_DIRECT with EINVAL.
+    inline Si::error_or<Si::file_handle> open_reading_direct(Si::native_path_string name)
+    {
+        return detail::open_direct(name, O_RDONLY);
+    }
+
+    /// Like overwrite_file, but the data bypasses the page cache (O_DIRECT). See direct_file_sink.
+    inline Si::error_or<Si::file_handle> overwrite_file_direct(Si::native_path_string name)
+    {
+        return detail::open_direct(name, O_RDWR | O_TRUNC | O_CREAT);
+    }
+
+    /// Turns O_DIRECT off for a descriptor so that unaligned I/O becomes possible again.
+    inline boost::system::error_code disable_direct_io(Si::native_file_descriptor file)
+    {
+#ifdef __APPLE__
+        (void)file;
+#else
+        int const flags = fcntl(file, F_GETFL);
+        if ((flags < 0) || (fcntl(file, F_SETFL, flags & ~O_DIRECT) < 0))
+        {
+            return Si::get_last_error();
+        }
+#endif
+        return boost::system::error_code();
+    }
+#endif
+
     inline Si::error_or<Si::file_handle> open_read_write(Si::native_path_string name)
     {
         Si::native_file_descriptor const fd =
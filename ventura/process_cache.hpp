@@ -0,0 +1,879 @@
+#ifndef VENTURA_PROCESS_CACHE_HPP
+#define VENTURA_PROCESS_CACHE_HPP
+
+#include <ventura/detail/file_identity.hpp>
+#include <ventura/file_operations.hpp>
+#include <ventura/run_process.hpp>
+#include <ventura/write_file.hpp>
+#include <silicium/sink/function_sink.hpp>
+#include <boost/uuid/detail/sha1.hpp>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#define VENTURA_HAS_PROCESS_CACHE (VENTURA_HAS_RUN_PROCESS && VENTURA_HAS_WRITE_FILE)
+
+#if VENTURA_HAS_PROCESS_CACHE
+#ifndef _WIN32
+extern char **environ;
+#endif
+
+namespace ventura
+{
+    struct process_cache_statistics
+    {
+        boost::uint64_t hits;
+        boost::uint64_t misses;
+
+        /// runs that bypassed the cache because they read from standard input
+        boost::uint64_t uncacheable;
+
+        /// runs whose result could not be stored (the run itself succeeded)
+        boost::uint64_t store_failures;
+
+        boost::uint64_t evicted_entries;
+        boost::uint64_t evicted_bytes;
+
+        process_cache_statistics() BOOST_NOEXCEPT : hits(0),
+                                                    misses(0),
+                                                    uncacheable(0),
+                                                    store_failures(0),
+                                                    evicted_entries(0),
+                                                    evicted_bytes(0)
+        {
+        }
+    };
+
+    namespace detail
+    {
+        struct content_digest
+        {
+            void add_raw(void const *data, std::size_t size)
+            {
+                m_state.process_bytes(data, size);
+            }
+
+            void add_size(boost::uint64_t size)
+            {
+                std::array<unsigned char, 8> encoded;
+                for (std::size_t i = 0; i < encoded.size(); ++i)
+                {
+                    encoded[i] = static_cast<unsigned char>(size >> (i * 8));
+                }
+                add_raw(encoded.data(), encoded.size());
+            }
+
+            /// length-prefixed so that adjacent fields cannot be confused
+            void add(void const *data, std::size_t size)
+            {
+                add_size(size);
+                add_raw(data, size);
+            }
+
+            template <class Char>
+            void add(std::basic_string<Char> const &text)
+            {
+                add(text.data(), text.size() * sizeof(Char));
+            }
+
+            void add(char const *c_str)
+            {
+                add(c_str, std::strlen(c_str));
+            }
+
+            SILICIUM_USE_RESULT
+            Si::noexcept_string finish()
+            {
+                boost::uuids::detail::sha1::digest_type digest;
+                m_state.get_digest(digest);
+                unsigned char const *const bytes = reinterpret_cast<unsigned char const *>(&digest[0]);
+                char const digits[] = "0123456789abcdef";
+                Si::noexcept_string hex;
+                for (std::size_t i = 0; i < sizeof(digest); ++i)
+                {
+                    hex += digits[bytes[i] >> 4u];
+                    hex += digits[bytes[i] & 15u];
+                }
+                return hex;
+            }
+
+        private:
+            boost::uuids::detail::sha1 m_state;
+        };
+
+        SILICIUM_USE_RESULT
+        inline Si::noexcept_string digest_memory(Si::memory_range content)
+        {
+            content_digest digest;
+            digest.add_raw(content.begin(), static_cast<std::size_t>(content.size()));
+            return digest.finish();
+        }
+
+        /// Returns the digest of the raw content of the file or none if the file does not exist.
+        SILICIUM_USE_RESULT
+        inline Si::error_or<Si::optional<Si::noexcept_string>> digest_file(absolute_path const &file)
+        {
+            Si::error_or<Si::file_handle> const opened = open_reading(safe_c_str(to_native_range(file)));
+            if (opened.is_error())
+            {
+                if (opened.error() == boost::system::errc::no_such_file_or_directory)
+                {
+                    return Si::optional<Si::noexcept_string>();
+                }
+                return opened.error();
+            }
+            content_digest digest;
+            std::vector<char> buffer(1u << 16u);
+            for (;;)
+            {
+                Si::error_or<std::size_t> const read =
+                    Si::read(opened.get().handle, Si::make_contiguous_range(buffer));
+                if (read.is_error())
+                {
+                    return read.error();
+                }
+                if (read.get() == 0)
+                {
+                    break;
+                }
+                digest.add_raw(buffer.data(), read.get());
+            }
+            return Si::optional<Si::noexcept_string>(digest.finish());
+        }
+
+        inline void add_parent_environment(content_digest &digest)
+        {
+            std::vector<Si::os_string> variables;
+#ifdef _WIN32
+            Si::os_char *const block = GetEnvironmentStringsW();
+            if (!block)
+            {
+                Si::throw_last_error();
+            }
+            for (Si::os_char const *i = block; *i != L'\0'; i += wcslen(i) + 1)
+            {
+                variables.emplace_back(i);
+            }
+            FreeEnvironmentStringsW(block);
+#else
+            for (char **i = environ; *i; ++i)
+            {
+                variables.emplace_back(*i);
+            }
+#endif
+            std::sort(variables.begin(), variables.end());
+            digest.add_size(variables.size());
+            for (Si::os_string const &variable : variables)
+            {
+                digest.add(variable);
+            }
+        }
+
+        struct cached_action
+        {
+            int exit_code;
+            Si::noexcept_string standard_output;
+            Si::noexcept_string standard_error;
+            std::vector<Si::noexcept_string> outputs;
+
+            cached_action()
+                : exit_code(0)
+            {
+            }
+
+            std::vector<Si::noexcept_string> objects() const
+            {
+                std::vector<Si::noexcept_string> result = outputs;
+                result.emplace_back(standard_output);
+                result.emplace_back(standard_error);
+                return result;
+            }
+        };
+
+        SILICIUM_USE_RESULT
+        inline Si::optional<cached_action> load_action(boost::filesystem::path const &file)
+        {
+            std::ifstream in(file.string(), std::ios::binary);
+            cached_action result;
+            if (!(in >> result.exit_code >> result.standard_output >> result.standard_error))
+            {
+                return Si::none;
+            }
+            std::string output;
+            while (in >> output)
+            {
+                result.outputs.emplace_back(output.c_str());
+            }
+            return result;
+        }
+
+        SILICIUM_USE_RESULT
+        inline Si::noexcept_string format_action(cached_action const &action)
+        {
+            Si::noexcept_string result = boost::lexical_cast<Si::noexcept_string>(action.exit_code);
+            result += '\n';
+            result += action.standard_output;
+            result += '\n';
+            result += action.standard_error;
+            result += '\n';
+            for (Si::noexcept_string const &output : action.outputs)
+            {
+                result += output;
+                result += '\n';
+            }
+            return result;
+        }
+    }
+
+    /// An opt-in action cache around run_process. The key of an action is a digest of the executable content,
+    /// the arguments, the environment, the working directory and the declared input and output files. The
+    /// exit code, stdout, stderr and the declared output files are kept in a content-addressed store on disk.
+    /// On a hit, the outputs are restored and nothing is launched.
+    struct process_cache
+    {
+        /// @param root a directory owned by the cache, created on demand
+        /// @param maximum_size the least recently used entries are evicted when the store exceeds this many bytes
+        explicit process_cache(absolute_path root, boost::uint64_t maximum_size)
+            : m_actions(root / "actions")
+            , m_objects(root / "objects")
+            , m_staging(root / "staging")
+            , m_maximum_size(maximum_size)
+        {
+        }
+
+        /// Runs the process or replays a cached result. Processes reading from standard input (parameters.in set)
+        /// are not cacheable and always run.
+        SILICIUM_USE_RESULT
+        Si::error_or<int> run(process_parameters const &parameters, std::vector<absolute_path> const &inputs,
+                              std::vector<absolute_path> const &outputs)
+        {
+            if (parameters.in)
+            {
+                count(&process_cache_statistics::uncacheable);
+                return run_process(parameters);
+            }
+
+            Si::error_or<Si::noexcept_string> const key = action_key(parameters, inputs, outputs);
+            if (key.is_error())
+            {
+                return key.error();
+            }
+
+            Si::optional<int> const replayed = replay(key.get(), parameters, outputs);
+            if (replayed)
+            {
+                count(&process_cache_statistics::hits);
+                return *replayed;
+            }
+            count(&process_cache_statistics::misses);
+
+            std::vector<char> std_output;
+            std::vector<char> std_error;
+            auto recording_output = Si::Sink<char, Si::success>::erase(
+                Si::make_function_sink<char>([&std_output, &parameters](Si::iterator_range<char const *> data)
+                                                 -> Si::success
+                                             {
+                                                 std_output.insert(std_output.end(), data.begin(), data.end());
+                                                 if (parameters.out)
+                                                 {
+                                                     parameters.out->append(data);
+                                                 }
+                                                 return {};
+                                             }));
+            auto recording_error = Si::Sink<char, Si::success>::erase(
+                Si::make_function_sink<char>([&std_error, &parameters](Si::iterator_range<char const *> data)
+                                                 -> Si::success
+                                             {
+                                                 std_error.insert(std_error.end(), data.begin(), data.end());
+                                                 if (parameters.err)
+                                                 {
+                                                     parameters.err->append(data);
+                                                 }
+                                                 return {};
+                                             }));
+            process_parameters recording = parameters;
+            recording.out = &recording_output;
+            recording.err = &recording_error;
+            Si::error_or<int> const result = run_process(recording);
+            if (result.is_error())
+            {
+                return result;
+            }
+            if (!!store(key.get(), result.get(), Si::make_memory_range(std_output), Si::make_memory_range(std_error),
+                        outputs))
+            {
+                count(&process_cache_statistics::store_failures);
+            }
+            return result;
+        }
+
+        SILICIUM_USE_RESULT
+        process_cache_statistics statistics() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_statistics;
+        }
+
+        /// Removes least recently used entries until the store is not larger than maximum_size. Objects that are
+        /// not referenced by any entry are removed, too.
+        SILICIUM_USE_RESULT
+        boost::system::error_code evict(boost::uint64_t maximum_size)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return evict_locked(maximum_size);
+        }
+
+    private:
+        absolute_path m_actions;
+        absolute_path m_objects;
+
+        /// Files are written here and renamed into the actions or objects when they are complete. The eviction scans
+        /// only those two directories, so it never sees a file that a store is still writing.
+        absolute_path m_staging;
+        boost::uint64_t m_maximum_size;
+        mutable std::mutex m_mutex;
+        process_cache_statistics m_statistics;
+
+        /// approximate size of the store; unknown until the first eviction scan
+        Si::optional<boost::uint64_t> m_size;
+
+        /// Objects that a store in progress is going to refer to. They are not referenced by an action file yet, so
+        /// the eviction has to leave them alone until the store has renamed its action file into place.
+        std::map<Si::noexcept_string, std::size_t> m_pinned;
+
+#ifndef _WIN32
+        struct memoized_digest
+        {
+            detail::file_identity identity;
+            Si::noexcept_string digest;
+        };
+
+        /// the digests of executables and declared inputs together with the identity of the file that was hashed
+        std::map<absolute_path, memoized_digest> m_file_digests;
+#endif
+
+        /// unpins the objects of a store when it is done, successful or not
+        struct pinned_objects
+        {
+            explicit pinned_objects(process_cache &cache)
+                : m_cache(cache)
+            {
+            }
+
+            ~pinned_objects()
+            {
+                std::lock_guard<std::mutex> lock(m_cache.m_mutex);
+                for (Si::noexcept_string const &digest : m_digests)
+                {
+                    auto const found = m_cache.m_pinned.find(digest);
+                    assert(found != m_cache.m_pinned.end());
+                    if (--found->second == 0)
+                    {
+                        m_cache.m_pinned.erase(found);
+                    }
+                }
+            }
+
+            /// has to be called before the object is looked up or written
+            void add(Si::noexcept_string const &digest)
+            {
+                std::lock_guard<std::mutex> lock(m_cache.m_mutex);
+                ++m_cache.m_pinned[digest];
+                m_digests.emplace_back(digest);
+            }
+
+        private:
+            process_cache &m_cache;
+            std::vector<Si::noexcept_string> m_digests;
+
+            SILICIUM_DELETED_FUNCTION(pinned_objects(pinned_objects const &))
+            SILICIUM_DELETED_FUNCTION(pinned_objects &operator=(pinned_objects const &))
+        };
+
+        void count(boost::uint64_t process_cache_statistics::*counter)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++(m_statistics.*counter);
+        }
+
+        SILICIUM_USE_RESULT
+        Si::error_or<Si::noexcept_string> action_key(process_parameters const &parameters,
+                                                     std::vector<absolute_path> const &inputs,
+                                                     std::vector<absolute_path> const &outputs)
+        {
+            detail::content_digest digest;
+            digest.add("ventura process_cache 1");
+            digest.add(to_os_string(parameters.executable));
+            {
+                Si::error_or<Si::optional<Si::noexcept_string>> const executable =
+                    digest_file(parameters.executable);
+                if (executable.is_error())
+                {
+                    return executable.error();
+                }
+                digest.add(executable.get() ? *executable.get() : Si::noexcept_string());
+            }
+            digest.add_size(parameters.arguments.size());
+            for (Si::os_string const &argument : parameters.arguments)
+            {
+                digest.add(argument);
+            }
+            digest.add(to_os_string(parameters.current_path));
+            switch (parameters.inheritance)
+            {
+            case environment_inheritance::inherit:
+                digest.add("inherit");
+                detail::add_parent_environment(digest);
+                break;
+
+            case environment_inheritance::no_inherit:
+                digest.add("no_inherit");
+                break;
+            }
+            digest.add_size(parameters.additional_environment.size());
+            for (auto const &variable : parameters.additional_environment)
+            {
+                digest.add(Si::os_string(variable.first));
+                digest.add(Si::os_string(variable.second));
+            }
+            digest.add_size(inputs.size());
+            for (absolute_path const &input : inputs)
+            {
+                digest.add(to_os_string(input));
+                Si::error_or<Si::optional<Si::noexcept_string>> const content = digest_file(input);
+                if (content.is_error())
+                {
+                    return content.error();
+                }
+                digest.add(content.get() ? *content.get() : Si::noexcept_string("missing"));
+            }
+            digest.add_size(outputs.size());
+            for (absolute_path const &output : outputs)
+            {
+                digest.add(to_os_string(output));
+            }
+            return digest.finish();
+        }
+
+        /// Like detail::digest_file, but a file is only hashed again when its device, inode, size or modification time
+        /// have changed since the last time, so an unchanged executable is not read for every run.
+        SILICIUM_USE_RESULT
+        Si::error_or<Si::optional<Si::noexcept_string>> digest_file(absolute_path const &file)
+        {
+#ifdef _WIN32
+            return detail::digest_file(file);
+#else
+            struct stat status;
+            if (stat(file.c_str(), &status) < 0)
+            {
+                if (errno == ENOENT)
+                {
+                    return Si::optional<Si::noexcept_string>();
+                }
+                return Si::get_last_error();
+            }
+            detail::file_identity const before = detail::make_file_identity(status);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto const found = m_file_digests.find(file);
+                if ((found != m_file_digests.end()) && (found->second.identity == before))
+                {
+                    return Si::optional<Si::noexcept_string>(found->second.digest);
+                }
+            }
+            Si::error_or<Si::optional<Si::noexcept_string>> const digest = detail::digest_file(file);
+            if (digest.is_error() || !digest.get())
+            {
+                return digest;
+            }
+            // a file that has been modified while it was being hashed is hashed again next time
+            if ((stat(file.c_str(), &status) == 0) && (detail::make_file_identity(status) == before))
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                memoized_digest &memoized = m_file_digests[file];
+                memoized.identity = before;
+                memoized.digest = *digest.get();
+            }
+            return digest;
+#endif
+        }
+
+        absolute_path action_file(Si::noexcept_string const &key) const
+        {
+            return m_actions / relative_path(key);
+        }
+
+        absolute_path object_file(Si::noexcept_string const &digest) const
+        {
+            return m_objects / relative_path(digest);
+        }
+
+        SILICIUM_USE_RESULT
+        Si::optional<int> replay(Si::noexcept_string const &key, process_parameters const &parameters,
+                                 std::vector<absolute_path> const &outputs)
+        {
+            absolute_path const action = action_file(key);
+            Si::optional<detail::cached_action> const loaded = detail::load_action(action.to_boost_path());
+            if (!loaded || (loaded->outputs.size() != outputs.size()))
+            {
+                return Si::none;
+            }
+
+            // an entry is only usable when eviction has not removed any of its objects
+            for (Si::noexcept_string const &object : loaded->objects())
+            {
+                if (!file_exists(object_file(object)).get())
+                {
+                    return Si::none;
+                }
+            }
+
+            // An object can still disappear before it is read. The streams are read before anything is restored, so
+            // that this is a miss without a partial output that would be repeated by running the process.
+            std::vector<char> standard_output;
+            std::vector<char> standard_error;
+            if (!load_stream(loaded->standard_output, parameters.out, standard_output) ||
+                !load_stream(loaded->standard_error, parameters.err, standard_error))
+            {
+                return Si::none;
+            }
+            for (std::size_t i = 0; i < outputs.size(); ++i)
+            {
+                if (!!copy(object_file(loaded->outputs[i]), outputs[i], Si::return_))
+                {
+                    return Si::none;
+                }
+            }
+            replay_stream(standard_output, parameters.out);
+            replay_stream(standard_error, parameters.err);
+
+            // the modification time of an entry is its last use for the LRU eviction
+            boost::system::error_code ignored;
+            boost::filesystem::last_write_time(action.to_boost_path(), std::time(nullptr), ignored);
+            return loaded->exit_code;
+        }
+
+        /// @return false if the object could not be read
+        SILICIUM_USE_RESULT
+        bool load_stream(Si::noexcept_string const &object, Si::Sink<char, Si::success>::interface const *destination,
+                         std::vector<char> &content) const
+        {
+            if (!destination)
+            {
+                return true;
+            }
+            // read_file for a path throws when the file does not exist
+            Si::error_or<Si::file_handle> const opened = open_reading(safe_c_str(to_native_range(object_file(object))));
+            if (opened.is_error())
+            {
+                return false;
+            }
+            Si::error_or<std::vector<char>> read = read_file(opened.get().handle);
+            if (read.is_error())
+            {
+                return false;
+            }
+            content = read.move_value();
+            return true;
+        }
+
+        static void replay_stream(std::vector<char> const &content,
+                                  Si::Sink<char, Si::success>::interface *destination)
+        {
+            if (!destination || content.empty())
+            {
+                return;
+            }
+            destination->append(Si::make_memory_range(content));
+        }
+
+        SILICIUM_USE_RESULT
+        Si::error_or<Si::noexcept_string> store_memory(Si::memory_range content, pinned_objects &pins,
+                                                       boost::uint64_t &added_bytes)
+        {
+            Si::noexcept_string digest = detail::digest_memory(content);
+            pins.add(digest);
+            absolute_path const destination = object_file(digest);
+            if (file_exists(destination).get())
+            {
+                return std::move(digest);
+            }
+            absolute_path const temporary = m_staging / unique_path();
+            boost::system::error_code error = write_file(safe_c_str(to_native_range(temporary)), content);
+            if (!error)
+            {
+                error = ventura::rename(temporary, destination);
+            }
+            if (!!error)
+            {
+                return error;
+            }
+            added_bytes += static_cast<boost::uint64_t>(content.size());
+            return std::move(digest);
+        }
+
+        SILICIUM_USE_RESULT
+        Si::error_or<Si::noexcept_string> store_file(absolute_path const &file, pinned_objects &pins,
+                                                     boost::uint64_t &added_bytes)
+        {
+            Si::error_or<Si::optional<Si::noexcept_string>> const digest = detail::digest_file(file);
+            if (digest.is_error())
+            {
+                return digest.error();
+            }
+            if (!digest.get())
+            {
+                // a declared output that was not produced cannot be restored later
+                return boost::system::errc::make_error_code(boost::system::errc::no_such_file_or_directory);
+            }
+            pins.add(*digest.get());
+            absolute_path const destination = object_file(*digest.get());
+            if (file_exists(destination).get())
+            {
+                return *digest.get();
+            }
+            absolute_path const temporary = m_staging / unique_path();
+            boost::system::error_code error = copy(file, temporary, Si::return_);
+            if (!error)
+            {
+                error = ventura::rename(temporary, destination);
+            }
+            if (!!error)
+            {
+                return error;
+            }
+            boost::uintmax_t const size = boost::filesystem::file_size(destination.to_boost_path(), error);
+            if (!error)
+            {
+                added_bytes += size;
+            }
+            return *digest.get();
+        }
+
+        SILICIUM_USE_RESULT
+        boost::system::error_code store(Si::noexcept_string const &key, int exit_code,
+                                        Si::memory_range standard_output, Si::memory_range standard_error,
+                                        std::vector<absolute_path> const &outputs)
+        {
+            boost::system::error_code error = create_directories(m_actions, Si::return_);
+            if (!error)
+            {
+                error = create_directories(m_objects, Si::return_);
+            }
+            if (!error)
+            {
+                error = create_directories(m_staging, Si::return_);
+            }
+            if (!!error)
+            {
+                return error;
+            }
+
+            pinned_objects pins(*this);
+            boost::uint64_t added_bytes = 0;
+            detail::cached_action action;
+            action.exit_code = exit_code;
+            {
+                Si::error_or<Si::noexcept_string> stored = store_memory(standard_output, pins, added_bytes);
+                if (stored.is_error())
+                {
+                    return stored.error();
+                }
+                action.standard_output = stored.move_value();
+            }
+            {
+                Si::error_or<Si::noexcept_string> stored = store_memory(standard_error, pins, added_bytes);
+                if (stored.is_error())
+                {
+                    return stored.error();
+                }
+                action.standard_error = stored.move_value();
+            }
+            for (absolute_path const &output : outputs)
+            {
+                Si::error_or<Si::noexcept_string> stored = store_file(output, pins, added_bytes);
+                if (stored.is_error())
+                {
+                    return stored.error();
+                }
+                action.outputs.emplace_back(stored.move_value());
+            }
+
+            // write and rename so that concurrent readers never see a partial entry
+            Si::noexcept_string const formatted = detail::format_action(action);
+            absolute_path const temporary = m_staging / unique_path();
+            error = write_file(safe_c_str(to_native_range(temporary)),
+                               Si::make_memory_range(formatted.data(), formatted.data() + formatted.size()));
+            if (!error)
+            {
+                error = ventura::rename(temporary, action_file(key));
+            }
+            if (!!error)
+            {
+                return error;
+            }
+            added_bytes += formatted.size();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_size)
+            {
+                *m_size += added_bytes;
+                if (*m_size <= m_maximum_size)
+                {
+                    return error;
+                }
+            }
+            return evict_locked(m_maximum_size);
+        }
+
+        SILICIUM_USE_RESULT
+        boost::system::error_code evict_locked(boost::uint64_t maximum_size)
+        {
+            struct action_entry
+            {
+                boost::filesystem::path file;
+                std::time_t last_use;
+                boost::uint64_t size;
+                std::vector<Si::noexcept_string> objects;
+            };
+
+            struct object_entry
+            {
+                boost::uint64_t size;
+                std::size_t references;
+            };
+
+            boost::system::error_code error;
+            boost::uint64_t total = 0;
+            std::map<Si::noexcept_string, object_entry> objects;
+            if (boost::filesystem::exists(m_objects.to_boost_path(), error))
+            {
+                for (boost::filesystem::directory_iterator i(m_objects.to_boost_path(), error);
+                     !error && (i != boost::filesystem::directory_iterator()); i.increment(error))
+                {
+                    object_entry object = {boost::filesystem::file_size(i->path(), error), 0};
+                    if (!!error)
+                    {
+                        return error;
+                    }
+                    total += object.size;
+                    objects.insert(std::make_pair(Si::noexcept_string(i->path().filename().string().c_str()), object));
+                }
+            }
+            if (!!error)
+            {
+                return error;
+            }
+
+            std::vector<action_entry> actions;
+            if (boost::filesystem::exists(m_actions.to_boost_path(), error))
+            {
+                for (boost::filesystem::directory_iterator i(m_actions.to_boost_path(), error);
+                     !error && (i != boost::filesystem::directory_iterator()); i.increment(error))
+                {
+                    action_entry action;
+                    action.file = i->path();
+                    action.last_use = boost::filesystem::last_write_time(action.file, error);
+                    if (!error)
+                    {
+                        action.size = boost::filesystem::file_size(action.file, error);
+                    }
+                    if (!!error)
+                    {
+                        return error;
+                    }
+                    Si::optional<detail::cached_action> const loaded = detail::load_action(action.file);
+                    if (loaded)
+                    {
+                        action.objects = loaded->objects();
+                    }
+                    for (Si::noexcept_string const &object : action.objects)
+                    {
+                        auto const found = objects.find(object);
+                        if (found != objects.end())
+                        {
+                            ++found->second.references;
+                        }
+                    }
+                    total += action.size;
+                    actions.emplace_back(std::move(action));
+                }
+            }
+            if (!!error)
+            {
+                return error;
+            }
+
+            auto const remove_object = [this, &objects, &total](std::map<Si::noexcept_string, object_entry>::iterator
+                                                                    object) -> boost::system::error_code
+            {
+                boost::system::error_code ec;
+                boost::filesystem::remove(object_file(object->first).to_boost_path(), ec);
+                if (!ec)
+                {
+                    total -= object->second.size;
+                    m_statistics.evicted_bytes += object->second.size;
+                    objects.erase(object);
+                }
+                return ec;
+            };
+
+            for (auto i = objects.begin(); i != objects.end();)
+            {
+                auto const current = i++;
+                if ((current->second.references == 0) && (m_pinned.count(current->first) == 0))
+                {
+                    error = remove_object(current);
+                    if (!!error)
+                    {
+                        return error;
+                    }
+                }
+            }
+
+            std::sort(actions.begin(), actions.end(), [](action_entry const &left, action_entry const &right)
+                      {
+                          return left.last_use < right.last_use;
+                      });
+            for (action_entry const &action : actions)
+            {
+                if (total <= maximum_size)
+                {
+                    break;
+                }
+                boost::filesystem::remove(action.file, error);
+                if (!!error)
+                {
+                    return error;
+                }
+                total -= action.size;
+                ++m_statistics.evicted_entries;
+                m_statistics.evicted_bytes += action.size;
+                for (Si::noexcept_string const &object : action.objects)
+                {
+                    auto const found = objects.find(object);
+                    if ((found == objects.end()) || (--found->second.references != 0) ||
+                        (m_pinned.count(object) != 0))
+                    {
+                        continue;
+                    }
+                    error = remove_object(found);
+                    if (!!error)
+                    {
+                        return error;
+                    }
+                }
+            }
+            m_size = total;
+            return error;
+        }
+    };
+}
+#endif
+
+#endif
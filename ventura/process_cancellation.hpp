@@ -0,0 +1,233 @@
+#ifndef VENTURA_PROCESS_CANCELLATION_HPP
+#define VENTURA_PROCESS_CANCELLATION_HPP
+
+#include <silicium/config.hpp>
+#include <silicium/optional.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+namespace ventura
+{
+    /// Lets another thread stop running processes. One object can be shared by any number of run_process calls.
+    struct process_cancellation
+    {
+        typedef std::size_t registration;
+
+        process_cancellation()
+            : m_cancelled(false)
+            , m_next_registration(0)
+        {
+        }
+
+        /// Terminates every process using this object now and every process started with it in the future.
+        void cancel()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_cancelled)
+            {
+                return;
+            }
+            m_cancelled = true;
+            for (auto const &handler : m_handlers)
+            {
+                handler.second();
+            }
+        }
+
+        SILICIUM_USE_RESULT
+        bool is_cancelled() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_cancelled;
+        }
+
+        /// The handler is called on cancellation with an internal lock held. If the object has already been
+        /// cancelled, the handler is called before this function returns.
+        SILICIUM_USE_RESULT
+        registration subscribe(std::function<void()> handler)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_cancelled)
+            {
+                handler();
+            }
+            registration const id = m_next_registration++;
+            m_handlers.insert(std::make_pair(id, std::move(handler)));
+            return id;
+        }
+
+        void unsubscribe(registration id)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_handlers.erase(id);
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        bool m_cancelled;
+        registration m_next_registration;
+        std::map<registration, std::function<void()>> m_handlers;
+
+        SILICIUM_DELETED_FUNCTION(process_cancellation(process_cancellation const &))
+        SILICIUM_DELETED_FUNCTION(process_cancellation &operator=(process_cancellation const &))
+    };
+
+#ifndef _WIN32
+    namespace detail
+    {
+        enum class watchdog_verdict
+        {
+            none,
+            timed_out,
+            cancelled
+        };
+
+        /// whether the child has terminated, without reaping it
+        inline bool has_exited(pid_t child) BOOST_NOEXCEPT
+        {
+            siginfo_t info = {};
+            if (waitid(P_PID, static_cast<id_t>(child), &info, WEXITED | WNOHANG | WNOWAIT) < 0)
+            {
+                return false;
+            }
+            // si_pid stays zero if the child is still running
+            return info.si_pid != 0;
+        }
+
+        /// Sends SIGTERM to a process group on the deadline or on cancellation, and SIGKILL if the group is still
+        /// alive after the grace period. The group ID is the process ID of its leader. If the leader has already
+        /// exited by then, there is no verdict because its exit code is real, and only what is left of the group is
+        /// terminated.
+        struct process_watchdog
+        {
+            process_watchdog(pid_t group, Si::optional<std::chrono::steady_clock::time_point> deadline,
+                             std::chrono::steady_clock::duration grace_period, process_cancellation *cancellation)
+                : m_group(group)
+                , m_deadline(deadline)
+                , m_grace_period(grace_period)
+                , m_cancellation(cancellation)
+                , m_stopped(false)
+                , m_cancel_requested(false)
+                , m_verdict(watchdog_verdict::none)
+            {
+                if (m_cancellation)
+                {
+                    m_registration = m_cancellation->subscribe([this]()
+                                                               {
+                                                                   std::lock_guard<std::mutex> lock(m_mutex);
+                                                                   m_cancel_requested = true;
+                                                                   m_changed.notify_all();
+                                                               });
+                }
+                m_thread = std::thread([this]()
+                                       {
+                                           watch();
+                                       });
+            }
+
+            ~process_watchdog()
+            {
+                stop();
+            }
+
+            /// Must be called before the process is reaped so that the process ID cannot be reused when the signals
+            /// are sent.
+            void stop()
+            {
+                if (!m_thread.joinable())
+                {
+                    return;
+                }
+                if (m_cancellation)
+                {
+                    m_cancellation->unsubscribe(m_registration);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopped = true;
+                    m_changed.notify_all();
+                }
+                m_thread.join();
+            }
+
+            SILICIUM_USE_RESULT
+            watchdog_verdict verdict() const
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_verdict;
+            }
+
+        private:
+            pid_t m_group;
+            Si::optional<std::chrono::steady_clock::time_point> m_deadline;
+            std::chrono::steady_clock::duration m_grace_period;
+            process_cancellation *m_cancellation;
+            process_cancellation::registration m_registration;
+            mutable std::mutex m_mutex;
+            std::condition_variable m_changed;
+            bool m_stopped;
+            bool m_cancel_requested;
+            watchdog_verdict m_verdict;
+            std::thread m_thread;
+
+            void watch()
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                auto const is_stopped_or_cancelled = [this]()
+                {
+                    return m_stopped || m_cancel_requested;
+                };
+                if (m_deadline)
+                {
+                    m_changed.wait_until(lock, *m_deadline, is_stopped_or_cancelled);
+                }
+                else
+                {
+                    m_changed.wait(lock, is_stopped_or_cancelled);
+                }
+                if (m_stopped)
+                {
+                    return;
+                }
+                // the leader may have exited just before and run_process has not called stop yet
+                if (!has_exited(m_group))
+                {
+                    m_verdict = m_cancel_requested ? watchdog_verdict::cancelled : watchdog_verdict::timed_out;
+                }
+                kill(-m_group, SIGTERM);
+                if (!m_changed.wait_for(lock, m_grace_period, [this]()
+                                        {
+                                            return m_stopped;
+                                        }))
+                {
+                    kill(-m_group, SIGKILL);
+                }
+            }
+
+            SILICIUM_DELETED_FUNCTION(process_watchdog(process_watchdog const &))
+            SILICIUM_DELETED_FUNCTION(process_watchdog &operator=(process_watchdog const &))
+        };
+
+        /// waits for the child to terminate, but leaves it as a zombie so that its process ID stays reserved
+        inline void wait_without_reaping(pid_t child) BOOST_NOEXCEPT
+        {
+            siginfo_t info = {};
+            while ((waitid(P_PID, static_cast<id_t>(child), &info, WEXITED | WNOWAIT) < 0) && (errno == EINTR))
+            {
+            }
+        }
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef VENTURA_PROCESS_GRAPH_HPP
+#define VENTURA_PROCESS_GRAPH_HPP
+
+#include <ventura/run_process.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+#define VENTURA_HAS_PROCESS_GRAPH VENTURA_HAS_RUN_PROCESS
+
+#if VENTURA_HAS_PROCESS_GRAPH
+namespace ventura
+{
+    typedef std::size_t process_node_id;
+
+    /// A set of commands with dependencies between them. The graph must be acyclic.
+    struct process_graph
+    {
+        struct node
+        {
+            /// identifies the command across runs for the duration history
+            Si::noexcept_string name;
+            process_parameters parameters;
+            std::vector<process_node_id> dependents;
+            std::size_t dependency_count;
+        };
+
+        process_node_id add(Si::noexcept_string name, process_parameters parameters)
+        {
+            node added;
+            added.name = std::move(name);
+            added.parameters = std::move(parameters);
+            added.dependency_count = 0;
+            m_nodes.emplace_back(std::move(added));
+            return m_nodes.size() - 1;
+        }
+
+        /// dependent will not start before dependency has finished successfully
+        void depend(process_node_id dependent, process_node_id dependency)
+        {
+            assert(dependent < m_nodes.size());
+            assert(dependency < m_nodes.size());
+            m_nodes[dependency].dependents.emplace_back(dependent);
+            ++m_nodes[dependent].dependency_count;
+        }
+
+        std::vector<node> const &nodes() const BOOST_NOEXCEPT
+        {
+            return m_nodes;
+        }
+
+    private:
+        std::vector<node> m_nodes;
+    };
+
+    /// Durations of earlier runs by node name. The scheduler reads estimates from here and records the new
+    /// measurements after each successful command. Persisting it between builds is up to the caller.
+    typedef std::map<Si::noexcept_string, std::chrono::milliseconds> process_duration_history;
+
+    enum class process_node_state
+    {
+        succeeded,
+
+        /// the command could not be run or exited with non-zero
+        failed,
+
+        /// a dependency failed, so the command was never launched
+        cancelled
+    };
+
+    struct process_node_result
+    {
+        process_node_state state;
+
+        /// only meaningful if the process could be run
+        int exit_code;
+
+        boost::system::error_code error;
+
+        /// what() of an exception other than boost::system::system_error that was thrown while running the command
+        Si::noexcept_string exception;
+
+        std::chrono::milliseconds duration;
+
+        process_node_result()
+            : state(process_node_state::cancelled)
+            , exit_code(-1)
+            , duration(0)
+        {
+        }
+    };
+
+    namespace detail
+    {
+        /// The priority of a node is the estimated length of the longest path from the start of the node to the
+        /// end of the whole graph. Starting the node on the critical path first minimizes the total duration.
+        inline std::vector<std::chrono::milliseconds>
+        estimate_critical_paths(process_graph const &graph, process_duration_history const &history)
+        {
+            std::vector<process_graph::node> const &nodes = graph.nodes();
+
+            // commands without history are assumed to be average
+            std::chrono::milliseconds default_estimate(1);
+            if (!history.empty())
+            {
+                std::chrono::milliseconds sum(0);
+                for (auto const &entry : history)
+                {
+                    sum += entry.second;
+                }
+                default_estimate =
+                    (std::max)(std::chrono::milliseconds(1), sum / static_cast<std::int64_t>(history.size()));
+            }
+
+            // Kahn's algorithm yields a topological order and detects cycles
+            std::vector<std::size_t> remaining_dependencies(nodes.size());
+            std::vector<process_node_id> order;
+            order.reserve(nodes.size());
+            for (process_node_id i = 0; i < nodes.size(); ++i)
+            {
+                remaining_dependencies[i] = nodes[i].dependency_count;
+                if (remaining_dependencies[i] == 0)
+                {
+                    order.emplace_back(i);
+                }
+            }
+            for (std::size_t i = 0; i < order.size(); ++i)
+            {
+                for (process_node_id dependent : nodes[order[i]].dependents)
+                {
+                    if (--remaining_dependencies[dependent] == 0)
+                    {
+                        order.emplace_back(dependent);
+                    }
+                }
+            }
+            if (order.size() != nodes.size())
+            {
+                boost::throw_exception(std::invalid_argument("process_graph contains a cycle"));
+            }
+
+            std::vector<std::chrono::milliseconds> critical_path(nodes.size());
+            for (auto i = order.rbegin(); i != order.rend(); ++i)
+            {
+                process_graph::node const &current = nodes[*i];
+                auto const known = history.find(current.name);
+                std::chrono::milliseconds const own = (known == history.end()) ? default_estimate : known->second;
+                std::chrono::milliseconds longest_tail(0);
+                for (process_node_id dependent : current.dependents)
+                {
+                    longest_tail = (std::max)(longest_tail, critical_path[dependent]);
+                }
+                critical_path[*i] = own + longest_tail;
+            }
+            return critical_path;
+        }
+    }
+
+    /// Runs every command of the graph after its dependencies with at most max_parallelism processes at the same
+    /// time. Ready commands are started in the order of their estimated critical path length. When a command
+    /// fails, everything that depends on it directly or indirectly is cancelled. Independent commands continue.
+    /// @return one result per node, indexed by process_node_id
+    inline std::vector<process_node_result> run_process_graph(process_graph const &graph,
+                                                              std::size_t max_parallelism,
+                                                              process_duration_history &history)
+    {
+        std::vector<process_graph::node> const &nodes = graph.nodes();
+        std::vector<std::chrono::milliseconds> const priorities = detail::estimate_critical_paths(graph, history);
+        std::vector<process_node_result> results(nodes.size());
+        if (nodes.empty())
+        {
+            return results;
+        }
+
+        auto is_less_urgent = [&priorities](process_node_id left, process_node_id right)
+        {
+            return priorities[left] < priorities[right];
+        };
+        std::priority_queue<process_node_id, std::vector<process_node_id>, decltype(is_less_urgent)> ready(
+            is_less_urgent);
+        std::vector<std::size_t> remaining_dependencies(nodes.size());
+        for (process_node_id i = 0; i < nodes.size(); ++i)
+        {
+            remaining_dependencies[i] = nodes[i].dependency_count;
+            if (remaining_dependencies[i] == 0)
+            {
+                ready.push(i);
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::size_t undecided = nodes.size();
+
+        std::vector<bool> cancelled(nodes.size());
+        auto const cancel_dependents = [&nodes, &undecided, &cancelled](process_node_id failed)
+        {
+            std::vector<process_node_id> pending = nodes[failed].dependents;
+            while (!pending.empty())
+            {
+                process_node_id const current = pending.back();
+                pending.pop_back();
+
+                // nodes with more than one failed dependency are reached more than once
+                if (cancelled[current])
+                {
+                    continue;
+                }
+                cancelled[current] = true;
+                --undecided;
+                pending.insert(pending.end(), nodes[current].dependents.begin(), nodes[current].dependents.end());
+            }
+        };
+
+        auto const work = [&]()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;)
+            {
+                changed.wait(lock, [&]()
+                             {
+                                 return !ready.empty() || (undecided == 0);
+                             });
+                if (ready.empty())
+                {
+                    return;
+                }
+                process_node_id const current = ready.top();
+                ready.pop();
+                lock.unlock();
+
+                process_node_result result;
+                auto const started = std::chrono::steady_clock::now();
+                try
+                {
+                    Si::error_or<int> const exit_code = run_process(nodes[current].parameters);
+                    if (exit_code.is_error())
+                    {
+                        result.error = exit_code.error();
+                    }
+                    else
+                    {
+                        result.exit_code = exit_code.get();
+                    }
+                }
+                catch (boost::system::system_error const &ex)
+                {
+                    result.error = ex.code();
+                }
+                catch (std::exception const &ex)
+                {
+                    // the exit code stays -1, so the node fails and its dependents are cancelled
+                    result.exception = ex.what();
+                }
+                catch (...)
+                {
+                    // escaping the thread would terminate the whole program
+                    result.exception = "unknown exception";
+                }
+                result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - started);
+                result.state = (!result.error && (result.exit_code == 0)) ? process_node_state::succeeded
+                                                                          : process_node_state::failed;
+
+                lock.lock();
+                results[current] = result;
+                --undecided;
+                if (result.state == process_node_state::succeeded)
+                {
+                    history[nodes[current].name] = result.duration;
+                    for (process_node_id dependent : nodes[current].dependents)
+                    {
+                        if (--remaining_dependencies[dependent] == 0)
+                        {
+                            ready.push(dependent);
+                        }
+                    }
+                }
+                else
+                {
+                    cancel_dependents(current);
+                }
+                changed.notify_all();
+            }
+        };
+
+        // run_process is what supports the streams, the deadline and the resource usage of process_parameters, and
+        // it blocks. One thread per slot keeps all of that for the nodes. The threads mostly sleep in the system.
+        std::vector<std::thread> workers;
+        std::size_t const worker_count = (std::min)((std::max)(max_parallelism, std::size_t(1)), nodes.size());
+        for (std::size_t i = 0; i < worker_count; ++i)
+        {
+            workers.emplace_back(work);
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        return results;
+    }
+}
+#endif
+
+#endif
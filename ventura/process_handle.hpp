@@ -6,11 +6,36 @@
 #include <boost/swap.hpp>
 
 #ifndef _WIN32
+#include <sys/resource.h>
 #include <sys/wait.h>
 #endif
 
 namespace ventura
 {
+#ifndef _WIN32
+    /// what the kernel reports about a child that has exited
+    struct process_resource_usage
+    {
+        boost::uint64_t peak_resident_bytes;
+        boost::uint64_t user_microseconds;
+        boost::uint64_t system_microseconds;
+
+        process_resource_usage() BOOST_NOEXCEPT : peak_resident_bytes(0),
+                                                  user_microseconds(0),
+                                                  system_microseconds(0)
+        {
+        }
+    };
+
+    namespace detail
+    {
+        inline boost::uint64_t to_microseconds(timeval const &time) BOOST_NOEXCEPT
+        {
+            return static_cast<boost::uint64_t>(time.tv_sec) * 1000000u + static_cast<boost::uint64_t>(time.tv_usec);
+        }
+    }
+#endif
+
 #ifdef _WIN32
     struct process_handle
     {
@@ -117,6 +142,35 @@ namespace ventura
             return exit_status;
         }
 
+        SILICIUM_USE_RESULT
+        Si::error_or<int> wait_for_exit(process_resource_usage &usage) BOOST_NOEXCEPT
+        {
+            int status = 0;
+            int wait_id = Si::exchange(m_id, -1);
+            assert(wait_id >= 1);
+            rusage measured = {};
+            if (wait4(wait_id, &status, 0, &measured) < 0)
+            {
+                return Si::get_last_error();
+            }
+            usage.peak_resident_bytes = static_cast<boost::uint64_t>(measured.ru_maxrss)
+#ifndef __APPLE__
+                                        // kilobytes everywhere but on OS X
+                                        * 1024u
+#endif
+                ;
+            usage.user_microseconds = detail::to_microseconds(measured.ru_utime);
+            usage.system_microseconds = detail::to_microseconds(measured.ru_stime);
+            int const exit_status = WEXITSTATUS(status);
+            return exit_status;
+        }
+
+        SILICIUM_USE_RESULT
+        pid_t id() const BOOST_NOEXCEPT
+        {
+            return m_id;
+        }
+
     private:
         pid_t m_id;
 
@@ -2,13 +2,18 @@
 #define VENTURA_PROCESS_PARAMETERS_HPP
 
 #include <boost/filesystem/path.hpp>
+#include <silicium/file_handle.hpp>
 #include <silicium/os_string.hpp>
 #include <silicium/sink/sink.hpp>
 #include <silicium/source/source.hpp>
 #include <silicium/success.hpp>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <ventura/absolute_path.hpp>
+#include <ventura/process_cancellation.hpp>
+#include <ventura/process_handle.hpp>
+#include <ventura/process_scheduling.hpp>
 
 namespace ventura
 {
@@ -44,6 +49,32 @@ namespace ventura
 
         environment_inheritance inheritance;
 
+#ifndef _WIN32
+        /// An open descriptor of the executable or -1 (see executable_handle::prepare). It is not owned and must stay
+        /// open until run_process returns.
+        Si::native_file_descriptor executable_file;
+
+        /// these file descriptors stay open in the child under the same numbers
+        std::vector<Si::native_file_descriptor> inherited_file_descriptors;
+
+        /// receives the resource usage of the child after it has exited. Ignored when nullptr.
+        process_resource_usage *resource_usage;
+
+        /// CPU affinity, priorities and resource limits of the child
+        process_scheduling scheduling;
+
+        /// When this point in time is reached, the child and its process group receive SIGTERM, followed by
+        /// SIGKILL after the kill_grace_period. run_process then returns errc::timed_out. What the child has
+        /// written to out and err until then has already been delivered.
+        Si::optional<std::chrono::steady_clock::time_point> deadline;
+
+        /// Like the deadline, but triggered by another thread. run_process returns errc::operation_canceled.
+        /// Ignored when nullptr.
+        process_cancellation *cancellation;
+
+        std::chrono::steady_clock::duration kill_grace_period;
+#endif
+
         process_parameters();
     };
 
@@ -52,6 +83,12 @@ namespace ventura
         , err(nullptr)
         , in(nullptr)
         , inheritance(environment_inheritance::inherit)
+#ifndef _WIN32
+        , executable_file(-1)
+        , resource_usage(nullptr)
+        , cancellation(nullptr)
+        , kill_grace_period(std::chrono::seconds(5))
+#endif
     {
     }
 }
@@ -0,0 +1,217 @@
+#ifndef VENTURA_PROCESS_SCHEDULING_HPP
+#define VENTURA_PROCESS_SCHEDULING_HPP
+
+#include <silicium/config.hpp>
+#include <silicium/optional.hpp>
+#include <boost/cstdint.hpp>
+#include <limits>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/resource.h>
+#include <sys/time.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#endif
+
+namespace ventura
+{
+#ifndef _WIN32
+    enum class scheduling_class
+    {
+        /// keep the policy of the parent
+        inherit,
+
+        /// SCHED_BATCH: for CPU-bound jobs that should not preempt interactive work (Linux only)
+        batch,
+
+        /// SCHED_IDLE: only runs when nothing else wants the CPU (Linux only)
+        idle
+    };
+
+    enum class io_priority_class
+    {
+        best_effort,
+        idle
+    };
+
+    struct io_priority
+    {
+        io_priority_class priority_class;
+
+        /// 0 (highest) to 7 (lowest), ignored for io_priority_class::idle
+        int level;
+    };
+
+    enum class resource_limit_type
+    {
+        /// RLIMIT_AS in bytes
+        address_space,
+
+        /// RLIMIT_CPU in seconds
+        cpu_seconds,
+
+        /// RLIMIT_NOFILE
+        open_files
+    };
+
+    struct resource_limit
+    {
+        resource_limit_type type;
+
+        /// The maximum value of boost::uint64_t means unlimited.
+        boost::uint64_t soft;
+        boost::uint64_t hard;
+    };
+
+    /// How the kernel treats a child process. Everything is applied in the child before exec, so the defaults
+    /// inherit the settings of the parent.
+    struct process_scheduling
+    {
+        /// the CPUs the child may run on, empty to inherit the mask (Linux only)
+        std::vector<unsigned> cpu_affinity;
+
+        /// the nice value of the child (-20 to 19)
+        Si::optional<int> nice;
+
+        scheduling_class policy;
+
+        /// the ioprio_set priority of the child (Linux only)
+        Si::optional<io_priority> io;
+
+        std::vector<resource_limit> limits;
+
+        process_scheduling()
+            : policy(scheduling_class::inherit)
+        {
+        }
+    };
+
+    namespace detail
+    {
+        inline int to_rlimit_resource(resource_limit_type type) BOOST_NOEXCEPT
+        {
+            switch (type)
+            {
+            case resource_limit_type::address_space:
+                return RLIMIT_AS;
+            case resource_limit_type::cpu_seconds:
+                return RLIMIT_CPU;
+            case resource_limit_type::open_files:
+                return RLIMIT_NOFILE;
+            }
+            SILICIUM_UNREACHABLE();
+        }
+
+        inline rlim_t to_rlim(boost::uint64_t value) BOOST_NOEXCEPT
+        {
+            if ((value == (std::numeric_limits<boost::uint64_t>::max)()) ||
+                (value >= static_cast<boost::uint64_t>(RLIM_INFINITY)))
+            {
+                return RLIM_INFINITY;
+            }
+            return static_cast<rlim_t>(value);
+        }
+
+        /// Applies the settings to the calling process. This is meant to be called in a forked child.
+        /// @return 0 or the errno value of the first failure
+        inline int apply_scheduling(process_scheduling const &scheduling) BOOST_NOEXCEPT
+        {
+            if (!scheduling.cpu_affinity.empty())
+            {
+#ifdef __linux__
+                cpu_set_t cpus;
+                CPU_ZERO(&cpus);
+                for (unsigned cpu : scheduling.cpu_affinity)
+                {
+                    if (cpu >= CPU_SETSIZE)
+                    {
+                        return EINVAL;
+                    }
+                    CPU_SET(cpu, &cpus);
+                }
+                if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0)
+                {
+                    return errno;
+                }
+#else
+                return ENOTSUP;
+#endif
+            }
+
+            switch (scheduling.policy)
+            {
+            case scheduling_class::inherit:
+                break;
+
+            case scheduling_class::batch:
+            case scheduling_class::idle:
+            {
+#ifdef __linux__
+                sched_param parameter = {};
+                parameter.sched_priority = 0;
+                if (sched_setscheduler(0, (scheduling.policy == scheduling_class::batch) ? SCHED_BATCH : SCHED_IDLE,
+                                       &parameter) < 0)
+                {
+                    return errno;
+                }
+#else
+                return ENOTSUP;
+#endif
+                break;
+            }
+            }
+
+            if (scheduling.nice)
+            {
+                if (setpriority(PRIO_PROCESS, 0, *scheduling.nice) < 0)
+                {
+                    return errno;
+                }
+            }
+
+            if (scheduling.io)
+            {
+#if defined(__linux__) && defined(SYS_ioprio_set)
+                // the constants from linux/ioprio.h which is not installed everywhere
+                int const ioprio_who_process = 1;
+                int const ioprio_class_shift = 13;
+                int const ioprio_class_best_effort = 2;
+                int const ioprio_class_idle = 3;
+                int const priority_class = (scheduling.io->priority_class == io_priority_class::best_effort)
+                                               ? ioprio_class_best_effort
+                                               : ioprio_class_idle;
+                int const level =
+                    (scheduling.io->priority_class == io_priority_class::best_effort) ? scheduling.io->level : 0;
+                if ((level < 0) || (level > 7))
+                {
+                    return EINVAL;
+                }
+                if (syscall(SYS_ioprio_set, ioprio_who_process, 0, (priority_class << ioprio_class_shift) | level) < 0)
+                {
+                    return errno;
+                }
+#else
+                return ENOTSUP;
+#endif
+            }
+
+            for (resource_limit const &limit : scheduling.limits)
+            {
+                rlimit const value = {to_rlim(limit.soft), to_rlim(limit.hard)};
+                if (setrlimit(to_rlimit_resource(limit.type), &value) < 0)
+                {
+                    return errno;
+                }
+            }
+            return 0;
+        }
+    }
+#endif
+}
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef VENTURA_RANDOM_ACCESS_FILE_HPP
+#define VENTURA_RANDOM_ACCESS_FILE_HPP
+
+#include <ventura/open.hpp>
+#include <ventura/file_size.hpp>
+#include <ventura/sink/file_sink.hpp>
+#include <silicium/memory_range.hpp>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+#define VENTURA_HAS_RANDOM_ACCESS_FILE 1
+#else
+#define VENTURA_HAS_RANDOM_ACCESS_FILE 0
+#endif
+
+#if VENTURA_HAS_RANDOM_ACCESS_FILE
+namespace ventura
+{
+    namespace detail
+    {
+        /// reads at least a prefix of the buffers at the offset without using or changing the file cursor
+        inline ssize_t positional_readv(Si::native_file_descriptor source, iovec const *vector, std::size_t count,
+                                        boost::uint64_t offset)
+        {
+#ifdef __linux__
+            return preadv64(source, vector, static_cast<int>(count), static_cast<off64_t>(offset));
+#elif defined(__FreeBSD__)
+            return preadv(source, vector, static_cast<int>(count), static_cast<off_t>(offset));
+#else
+            assert(count > 0);
+            (void)count;
+            return pread(source, vector->iov_base, vector->iov_len, static_cast<off_t>(offset));
+#endif
+        }
+
+        /// Advances the iovecs past a partial transfer.
+        /// @return the number of iovecs that are still left
+        inline std::size_t skip_transferred(iovec *&vector, std::size_t count, std::size_t transferred)
+        {
+            while ((count > 0) && (transferred >= vector->iov_len))
+            {
+                transferred -= vector->iov_len;
+                ++vector;
+                --count;
+            }
+            if (transferred > 0)
+            {
+                assert(count > 0);
+                vector->iov_base = static_cast<char *>(vector->iov_base) + transferred;
+                vector->iov_len -= transferred;
+            }
+            return count;
+        }
+    }
+
+    struct random_access_file;
+
+    /// A region of a random_access_file that is filled from the beginning by one writer. Different shards of the same
+    /// file can be written by different threads at the same time without any locking.
+    struct random_access_file_shard
+    {
+        random_access_file_shard() BOOST_NOEXCEPT : m_file(nullptr), m_begin(0), m_end(0), m_written(0)
+        {
+        }
+
+        random_access_file_shard(random_access_file &file, boost::uint64_t begin, boost::uint64_t end) BOOST_NOEXCEPT
+            : m_file(&file),
+              m_begin(begin),
+              m_end(end),
+              m_written(0)
+        {
+            assert(begin <= end);
+        }
+
+        /// Appends to the shard. Fails with errc::file_too_large if the data does not fit into the shard.
+        inline boost::system::error_code write(Si::memory_range data);
+
+        boost::uint64_t begin() const BOOST_NOEXCEPT
+        {
+            return m_begin;
+        }
+
+        boost::uint64_t end() const BOOST_NOEXCEPT
+        {
+            return m_end;
+        }
+
+        boost::uint64_t written() const BOOST_NOEXCEPT
+        {
+            return m_written;
+        }
+
+    private:
+        random_access_file *m_file;
+        boost::uint64_t m_begin;
+        boost::uint64_t m_end;
+        boost::uint64_t m_written;
+    };
+
+    /// A file for reading and writing at explicit offsets (pread and pwrite). The cursor of the file descriptor is
+    /// never used, so any number of threads can read and write concurrently. The size of the file is cached and
+    /// updated by the writes through this object.
+    struct random_access_file
+    {
+        random_access_file() BOOST_NOEXCEPT : m_size(0), m_allocated(0), m_growth_step(0)
+        {
+        }
+
+        /// @param growth_step when non-zero, writes beyond the allocated space reserve space in steps of at least this
+        /// many bytes (fallocate with FALLOC_FL_KEEP_SIZE) so that an extending file is not fragmented
+        explicit random_access_file(Si::file_handle file, boost::uint64_t size, boost::uint64_t growth_step = 0)
+            : m_file(std::move(file))
+            , m_size(size)
+            , m_allocated(size)
+            , m_growth_step(growth_step)
+        {
+        }
+
+        random_access_file(random_access_file &&other) BOOST_NOEXCEPT : m_file(std::move(other.m_file)),
+                                                                        m_size(other.m_size.load()),
+                                                                        m_allocated(other.m_allocated.load()),
+                                                                        m_growth_step(other.m_growth_step.load())
+        {
+        }
+
+        random_access_file &operator=(random_access_file &&other) BOOST_NOEXCEPT
+        {
+            m_file = std::move(other.m_file);
+            m_size = other.m_size.load();
+            m_allocated = other.m_allocated.load();
+            m_growth_step = other.m_growth_step.load();
+            return *this;
+        }
+
+        /// opens or creates the file without truncating it
+        SILICIUM_USE_RESULT
+        static Si::error_or<random_access_file> open(Si::native_path_string name, boost::uint64_t growth_step = 0)
+        {
+            Si::error_or<Si::file_handle> file = open_read_write(name);
+            if (file.is_error())
+            {
+                return file.error();
+            }
+            Si::error_or<Si::optional<boost::uint64_t>> const size = file_size(file.get().handle);
+            if (size.is_error())
+            {
+                return size.error();
+            }
+            if (!size.get())
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::invalid_seek);
+            }
+            return random_access_file(file.move_value(), *size.get(), growth_step);
+        }
+
+        Si::native_file_descriptor handle() const BOOST_NOEXCEPT
+        {
+            return m_file.handle;
+        }
+
+        /// the size of the file as far as this object knows
+        boost::uint64_t size() const BOOST_NOEXCEPT
+        {
+            return m_size.load();
+        }
+
+        /// updates the cached size from the file system in case someone else has changed the file
+        boost::system::error_code refresh_size()
+        {
+            Si::error_or<Si::optional<boost::uint64_t>> const size = file_size(m_file.handle);
+            if (size.is_error())
+            {
+                return size.error();
+            }
+            m_size = size.get() ? *size.get() : 0;
+            return boost::system::error_code();
+        }
+
+        /// Reads until the destination is full or the end of the file is reached.
+        /// @return the number of bytes read
+        SILICIUM_USE_RESULT
+        Si::error_or<std::size_t> read_at(boost::uint64_t offset, Si::iterator_range<char *> destination) const
+        {
+            iovec buffer;
+            buffer.iov_base = destination.begin();
+            buffer.iov_len = static_cast<std::size_t>(destination.size());
+            return read_vector_at(offset, &buffer, 1);
+        }
+
+        /// Scatters consecutive bytes of the file into the buffers (preadv) until they are full or the end of the file
+        /// is reached. The iovecs are modified.
+        /// @return the number of bytes read
+        SILICIUM_USE_RESULT
+        Si::error_or<std::size_t> read_vector_at(boost::uint64_t offset, iovec *buffers, std::size_t count) const
+        {
+            std::size_t total = 0;
+            while (count > 0)
+            {
+                std::size_t const chunk = (std::min)(count, detail::max_iovec_count);
+                ssize_t const read = detail::positional_readv(m_file.handle, buffers, chunk, offset + total);
+                if (read < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return Si::get_last_error();
+                }
+                if (read == 0)
+                {
+                    break;
+                }
+                total += static_cast<std::size_t>(read);
+                count = detail::skip_transferred(buffers, count, static_cast<std::size_t>(read));
+            }
+            return total;
+        }
+
+        SILICIUM_USE_RESULT
+        boost::system::error_code write_at(boost::uint64_t offset, Si::memory_range data)
+        {
+            iovec piece;
+            piece.iov_base = const_cast<void *>(static_cast<void const *>(data.begin()));
+            piece.iov_len = static_cast<std::size_t>(data.size());
+            return write_vector_at(offset, &piece, 1);
+        }
+
+        /// Gathers the pieces into consecutive bytes of the file (pwritev). The iovecs are modified.
+        SILICIUM_USE_RESULT
+        boost::system::error_code write_vector_at(boost::uint64_t offset, iovec *pieces, std::size_t count)
+        {
+            boost::uint64_t length = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                length += pieces[i].iov_len;
+            }
+            if (length == 0)
+            {
+                return boost::system::error_code();
+            }
+            boost::system::error_code const grown = grow_for(offset + length);
+            if (grown)
+            {
+                return grown;
+            }
+            boost::uint64_t written = 0;
+            while (count > 0)
+            {
+                std::size_t const chunk = (std::min)(count, detail::max_iovec_count);
+                ssize_t const result = detail::positional_writev(m_file.handle, pieces, chunk, offset + written);
+                if (result < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    update_size(offset + written);
+                    return Si::get_last_error();
+                }
+                written += static_cast<boost::uint64_t>(result);
+                count = detail::skip_transferred(pieces, count, static_cast<std::size_t>(result));
+            }
+            update_size(offset + written);
+            return boost::system::error_code();
+        }
+
+        /// Reserves disk space for the first capacity bytes without changing the size of the file.
+        SILICIUM_USE_RESULT
+        boost::system::error_code reserve(boost::uint64_t capacity)
+        {
+            std::lock_guard<std::mutex> lock(m_growing);
+            return reserve_locked(capacity);
+        }
+
+        /// Sets the size of the file, either cutting off the end or appending zeros.
+        SILICIUM_USE_RESULT
+        boost::system::error_code resize(boost::uint64_t size)
+        {
+            int const error = detail::truncate_to(m_file.handle, size);
+            if (error != 0)
+            {
+                return boost::system::error_code(error, boost::system::system_category());
+            }
+            m_size = size;
+            return boost::system::error_code();
+        }
+
+        /// Splits [begin, end) into count shards of about equal size for parallel writers. The space is reserved
+        /// first if possible.
+        std::vector<random_access_file_shard> make_shards(boost::uint64_t begin, boost::uint64_t end, std::size_t count)
+        {
+            assert(begin <= end);
+            assert(count > 0);
+            // reserving is only an optimization
+            boost::system::error_code const ignored = reserve(end);
+            (void)ignored;
+            std::vector<random_access_file_shard> shards;
+            shards.reserve(count);
+            boost::uint64_t const length = end - begin;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                boost::uint64_t const shard_begin = begin + (length * i / count);
+                boost::uint64_t const shard_end = begin + (length * (i + 1) / count);
+                shards.emplace_back(*this, shard_begin, shard_end);
+            }
+            return shards;
+        }
+
+    private:
+        Si::file_handle m_file;
+        std::atomic<boost::uint64_t> m_size;
+        std::atomic<boost::uint64_t> m_allocated;
+        std::atomic<boost::uint64_t> m_growth_step;
+        std::mutex m_growing;
+
+        void update_size(boost::uint64_t end) BOOST_NOEXCEPT
+        {
+            boost::uint64_t known = m_size.load();
+            while ((known < end) && !m_size.compare_exchange_weak(known, end))
+            {
+            }
+        }
+
+        boost::system::error_code grow_for(boost::uint64_t end)
+        {
+            if ((m_growth_step.load() == 0) || (end <= m_allocated.load()))
+            {
+                return boost::system::error_code();
+            }
+            std::lock_guard<std::mutex> lock(m_growing);
+            boost::uint64_t const allocated = m_allocated.load();
+            if (end <= allocated)
+            {
+                return boost::system::error_code();
+            }
+            boost::system::error_code const error = reserve_locked((std::max)(end, allocated + m_growth_step.load()));
+            if (error == boost::system::errc::not_supported)
+            {
+                // the file system cannot preallocate, so the write just extends the file
+                m_growth_step = 0;
+                return boost::system::error_code();
+            }
+            return error;
+        }
+
+        boost::system::error_code reserve_locked(boost::uint64_t capacity)
+        {
+            boost::uint64_t const allocated = m_allocated.load();
+            if (capacity <= allocated)
+            {
+                return boost::system::error_code();
+            }
+            int const error = detail::allocate_space(m_file.handle, allocated, capacity - allocated, true);
+            if (error != 0)
+            {
+                return boost::system::error_code(error, boost::system::system_category());
+            }
+            m_allocated = capacity;
+            return boost::system::error_code();
+        }
+    };
+
+    inline boost::system::error_code random_access_file_shard::write(Si::memory_range data)
+    {
+        assert(m_file);
+        boost::uint64_t const size = static_cast<boost::uint64_t>(data.size());
+        if (size > (m_end - m_begin - m_written))
+        {
+            return boost::system::errc::make_error_code(boost::system::errc::file_too_large);
+        }
+        boost::system::error_code const error = m_file->write_at(m_begin + m_written, data);
+        if (!error)
+        {
+            m_written += size;
+        }
+        return error;
+    }
+}
+#endif
+
+#endif
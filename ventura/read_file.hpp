@@ -3,6 +3,7 @@
 
 #include <silicium/read.hpp>
 #include <silicium/variant.hpp>
+#include <ventura/detail/read_loop.hpp>
 #include <ventura/file_size.hpp>
 #include <ventura/open.hpp>
 
@@ -11,46 +12,90 @@ namespace ventura
     enum class read_file_problem
     {
         file_too_large_for_memory,
-        concurrent_write_detected
+        concurrent_write_detected,
+        maximum_size_exceeded
     };
 
-    SILICIUM_USE_RESULT
-    inline Si::variant<std::vector<char>, boost::system::error_code, read_file_problem>
-    read_file(Si::native_path_string name)
+    /// Reads the whole content of a file into storage of the caller, which replaces the previous content. The
+    /// capacity of the container is reused, so reading the same file repeatedly allocates nothing once the container
+    /// is large enough. Files without a size like pipes and FIFOs and files that report a size of zero like the ones in
+    /// /proc are read until their end.
+    /// @param content a contiguous container of char like std::vector<char> or std::string, possibly with an allocator
+    /// from an arena
+    /// @param maximum_size the file is not read any further when it turns out to be larger
+    /// @return the size of the content
+    template <class ByteContainer>
+    SILICIUM_USE_RESULT Si::variant<std::size_t, boost::system::error_code, read_file_problem>
+    read_file_into(Si::native_path_string name, ByteContainer &content,
+                   std::size_t maximum_size = (std::numeric_limits<std::size_t>::max)())
     {
         Si::error_or<Si::file_handle> const file = open_reading(name);
         if (file.is_error())
         {
             return file.error();
         }
-        Si::error_or<Si::optional<boost::uint64_t>> const size = file_size(file.get().handle);
-        if (size.is_error())
+        Si::error_or<detail::file_version> const version = detail::get_file_version(file.get().handle);
+        if (version.is_error())
         {
-            return size.error();
+            return version.error();
         }
-        std::vector<char> content;
-        if (size.get())
+        if (version.get().regular && (version.get().size > 0))
         {
-            if (*size.get() > content.max_size())
+            if (version.get().size > content.max_size())
             {
                 return read_file_problem::file_too_large_for_memory;
             }
-            content.resize(static_cast<std::size_t>(*size.get()));
-            Si::error_or<std::size_t> const read = Si::read(file.get().handle, Si::make_contiguous_range(content));
+            if (version.get().size > maximum_size)
+            {
+                return read_file_problem::maximum_size_exceeded;
+            }
+            // only the part by which the container grows is initialized before it is overwritten
+            content.resize(static_cast<std::size_t>(version.get().size));
+            Si::error_or<Si::optional<std::size_t>> const read =
+                detail::read_known_size(file.get().handle, &content[0], content.size(), version.get());
             if (read.is_error())
             {
                 return read.error();
             }
-            if (read.get() != content.size())
+            if (!read.get())
             {
                 return read_file_problem::concurrent_write_detected;
             }
-            return content;
+            content.resize(*read.get());
+            return content.size();
+        }
+        content.clear();
+        Si::error_or<bool> const complete = detail::read_until_end(file.get().handle, content, maximum_size);
+        if (complete.is_error())
+        {
+            return complete.error();
+        }
+        if (!complete.get())
+        {
+            return (maximum_size < content.max_size()) ? read_file_problem::maximum_size_exceeded
+                                                        : read_file_problem::file_too_large_for_memory;
+        }
+        return content.size();
+    }
+
+    /// Reads the whole content of a file into a new vector. See read_file_into.
+    /// @param maximum_size the file is not read any further when it turns out to be larger
+    SILICIUM_USE_RESULT
+    inline Si::variant<std::vector<char>, boost::system::error_code, read_file_problem>
+    read_file(Si::native_path_string name, std::size_t maximum_size = (std::numeric_limits<std::size_t>::max)())
+    {
+        std::vector<char> content;
+        Si::variant<std::size_t, boost::system::error_code, read_file_problem> const result =
+            read_file_into(name, content, maximum_size);
+        if (boost::system::error_code const *const error = Si::try_get_ptr<boost::system::error_code>(result))
+        {
+            return *error;
         }
-        else
+        if (read_file_problem const *const problem = Si::try_get_ptr<read_file_problem>(result))
         {
-            boost::throw_exception(std::logic_error("not implemented yet"));
+            return *problem;
         }
+        return std::move(content);
     }
 }
 
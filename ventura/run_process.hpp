@@ -30,7 +30,9 @@ namespace ventura
 #define VENTURA_HAS_RUN_PROCESS (SILICIUM_HAS_EXCEPTIONS && VENTURA_HAS_LAUNCH_PROCESS)
 
 #if VENTURA_HAS_RUN_PROCESS
+#include <array>
 #include <future>
+#include <memory>
 
 namespace ventura
 {
@@ -56,6 +58,23 @@ namespace ventura
 #endif
         }
 
+        /// @return false if the pipe has been closed by the reader
+        inline bool write_all(Si::native_file_descriptor destination, char const *data, std::size_t size)
+        {
+            while (size > 0)
+            {
+                Si::error_or<size_t> const written = Si::write(destination, Si::make_memory_range(data, size));
+                if (written.is_error())
+                {
+                    return false;
+                }
+                assert(written.get() <= size);
+                data += written.get();
+                size -= written.get();
+            }
+            return true;
+        }
+
         inline Si::file_handle enable_inheritance(Si::file_handle original)
         {
 #ifdef _WIN32
@@ -71,14 +90,83 @@ namespace ventura
             return original;
 #endif
         }
+
+        /// forwards to a type-erased sink or discards the data if there is none
+        struct nullable_sink
+        {
+            typedef char element_type;
+            typedef Si::success error_type;
+
+            explicit nullable_sink(Si::Sink<char, Si::success>::interface *next) BOOST_NOEXCEPT : m_next(next)
+            {
+            }
+
+            error_type append(Si::iterator_range<char const *> data)
+            {
+                if (m_next)
+                {
+                    return m_next->append(data);
+                }
+                return error_type();
+            }
+
+        private:
+            Si::Sink<char, Si::success>::interface *m_next;
+        };
+
+        /// reads from a type-erased source or behaves like an empty source if there is none
+        struct nullable_source
+        {
+            typedef char element_type;
+
+            explicit nullable_source(Si::Source<char>::interface *next) BOOST_NOEXCEPT : m_next(next)
+            {
+            }
+
+            Si::iterator_range<char const *> map_next(std::size_t size)
+            {
+                if (m_next)
+                {
+                    return m_next->map_next(size);
+                }
+                return Si::iterator_range<char const *>();
+            }
+
+            char *copy_next(Si::iterator_range<char *> destination)
+            {
+                if (m_next)
+                {
+                    return m_next->copy_next(destination);
+                }
+                return destination.begin();
+            }
+
+        private:
+            Si::Source<char>::interface *m_next;
+        };
     }
 
-    inline Si::error_or<int> run_process(process_parameters const &parameters)
+    /// Like run_process(process_parameters const &), but the standard streams of the child are connected to the
+    /// given sinks and source instead of parameters.out, err and in. The types are known at compile time, so the
+    /// calls for each chunk can be inlined.
+    /// @param out a sink of char for the stdout of the child
+    /// @param err a sink of char for the stderr of the child
+    /// @param in a source of char that is copied to the stdin of the child in large blocks
+    template <class OutputSink, class ErrorSink, class InputSource>
+    Si::error_or<int> run_process(process_parameters const &parameters, OutputSink &&out, ErrorSink &&err,
+                                  InputSource &&in)
     {
         async_process_parameters async_parameters;
         async_parameters.executable = parameters.executable;
-        async_parameters.arguments = parameters.arguments;
+        // the arguments are passed to launch_process as a range below instead of being copied
         async_parameters.current_path = parameters.current_path;
+#ifndef _WIN32
+        async_parameters.executable_file = parameters.executable_file;
+        async_parameters.inherited_file_descriptors = parameters.inherited_file_descriptors;
+        async_parameters.scheduling = parameters.scheduling;
+        bool const is_watched = parameters.deadline || parameters.cancellation;
+        async_parameters.own_process_group = is_watched;
+#endif
         auto input = detail::make_pipe().move_value();
         auto std_output = detail::make_pipe().move_value();
         auto std_error = detail::make_pipe().move_value();
@@ -87,56 +175,56 @@ namespace ventura
         Si::file_handle inheritable_stdout_write = detail::enable_inheritance(std::move(std_output.write));
         Si::file_handle inheritable_stderr_write = detail::enable_inheritance(std::move(std_error.write));
         async_process process =
-            launch_process(async_parameters, inheritable_stdin_read.handle, inheritable_stdout_write.handle,
-                           inheritable_stderr_write.handle, parameters.additional_environment, parameters.inheritance)
+            detail::launch_process(async_parameters,
+                                   Si::make_iterator_range(parameters.arguments.data(),
+                                                           parameters.arguments.data() + parameters.arguments.size()),
+                                   inheritable_stdin_read.handle, inheritable_stdout_write.handle,
+                                   inheritable_stderr_write.handle, parameters.additional_environment,
+                                   parameters.inheritance)
                 .move_value();
 
         inheritable_stdin_read.close();
         inheritable_stdout_write.close();
         inheritable_stderr_write.close();
 
+#ifndef _WIN32
+        // terminating the child closes the pipes, which ends the reading below
+        std::unique_ptr<detail::process_watchdog> watchdog;
+        if (is_watched)
+        {
+            watchdog.reset(new detail::process_watchdog(process.process.id(), parameters.deadline,
+                                                        parameters.kill_grace_period, parameters.cancellation));
+        }
+#endif
+
         boost::asio::io_service io;
 
         boost::promise<void> stop_polling;
         boost::shared_future<void> stopped_polling = stop_polling.get_future().share();
 
-        auto std_output_consumer = Si::make_multi_sink<char, Si::success>(
-            [&parameters]()
-            {
-                return Si::make_iterator_range(&parameters.out, &parameters.out + (parameters.out != nullptr));
-            });
-        auto stdout_finished = experimental::read_from_anonymous_pipe(io, std_output_consumer,
-                                                                      std::move(std_output.read), stopped_polling);
-
-        auto std_error_consumer = Si::make_multi_sink<char, Si::success>(
-            [&parameters]()
-            {
-                return Si::make_iterator_range(&parameters.err, &parameters.err + (parameters.err != nullptr));
-            });
+        auto stdout_finished =
+            experimental::read_from_anonymous_pipe(io, out, std::move(std_output.read), stopped_polling);
         auto stderr_finished =
-            experimental::read_from_anonymous_pipe(io, std_error_consumer, std::move(std_error.read), stopped_polling);
+            experimental::read_from_anonymous_pipe(io, err, std::move(std_error.read), stopped_polling);
 
-        auto copy_input = std::async(std::launch::async, [&input, &parameters]()
+        auto copy_input = std::async(std::launch::async, [&input, &in]()
                                      {
-                                         if (!parameters.in)
-                                         {
-                                             return;
-                                         }
+                                         std::array<char, 4096> buffer;
                                          for (;;)
                                          {
-                                             Si::optional<char> const c = Si::get(*parameters.in);
-                                             if (!c)
+                                             char *const end =
+                                                 in.copy_next(Si::make_iterator_range(buffer.data(),
+                                                                                      buffer.data() + buffer.size()));
+                                             if (end == buffer.data())
                                              {
                                                  break;
                                              }
-                                             Si::error_or<size_t> written =
-                                                 write(input.write.handle, Si::make_memory_range(&*c, 1));
-                                             if (written.is_error())
+                                             if (!detail::write_all(input.write.handle, buffer.data(),
+                                                                    static_cast<std::size_t>(end - buffer.data())))
                                              {
                                                  // process must have exited
                                                  break;
                                              }
-                                             assert(written.get() == 1);
                                          }
                                          input.write.close();
                                      });
@@ -145,7 +233,39 @@ namespace ventura
         copy_input.get();
         stdout_finished.get();
         stderr_finished.get();
+#ifndef _WIN32
+        if (watchdog)
+        {
+            detail::wait_without_reaping(process.process.id());
+            watchdog->stop();
+        }
+        Si::error_or<int> const exit_code = parameters.resource_usage
+                                                ? process.wait_for_exit(*parameters.resource_usage)
+                                                : process.wait_for_exit();
+        if (watchdog)
+        {
+            switch (watchdog->verdict())
+            {
+            case detail::watchdog_verdict::none:
+                break;
+
+            case detail::watchdog_verdict::timed_out:
+                return boost::system::errc::make_error_code(boost::system::errc::timed_out);
+
+            case detail::watchdog_verdict::cancelled:
+                return boost::system::errc::make_error_code(boost::system::errc::operation_canceled);
+            }
+        }
+        return exit_code;
+#else
         return process.wait_for_exit();
+#endif
+    }
+
+    inline Si::error_or<int> run_process(process_parameters const &parameters)
+    {
+        return run_process(parameters, detail::nullable_sink(parameters.out), detail::nullable_sink(parameters.err),
+                           detail::nullable_source(parameters.in));
     }
 
 #ifdef _WIN32
@@ -178,7 +298,6 @@ namespace ventura
                 Si::make_transforming_source(Si::make_range_source(Si::make_contiguous_range(arguments)),
                                              [](Si::noexcept_string const &in) -> Si::os_string
                                              {
-                                                 // TODO: mvoe the string if possible
                                                  return Si::to_os_string(in);
                                              });
             Si::copy(arguments_encoder, new_arguments_sink);
@@ -186,6 +305,17 @@ namespace ventura
         return new_arguments;
     }
 
+    SILICIUM_USE_RESULT
+    inline std::vector<Si::os_string> arguments_to_os_strings(std::vector<Si::noexcept_string> &&arguments)
+    {
+#ifdef _WIN32
+        return arguments_to_os_strings(arguments);
+#else
+        // the strings already have the native encoding
+        return std::move(arguments);
+#endif
+    }
+
     SILICIUM_USE_RESULT
     inline Si::error_or<int>
     run_process(absolute_path executable, std::vector<Si::noexcept_string> arguments, absolute_path current_directory,
@@ -195,8 +325,7 @@ namespace ventura
     {
         process_parameters parameters;
         parameters.executable = std::move(executable);
-        std::vector<Si::os_string> new_arguments = arguments_to_os_strings(arguments);
-        parameters.arguments = std::move(new_arguments);
+        parameters.arguments = arguments_to_os_strings(std::move(arguments));
         parameters.current_path = std::move(current_directory);
         parameters.out = &output;
         parameters.err = &output;
@@ -0,0 +1,169 @@
+#ifndef VENTURA_BUFFERED_FILE_SINK_HPP
+#define VENTURA_BUFFERED_FILE_SINK_HPP
+
+#include <ventura/detail/aligned_buffer.hpp>
+#include <ventura/sink/file_sink.hpp>
+#include <algorithm>
+#include <array>
+
+namespace ventura
+{
+#if VENTURA_HAS_FILE_SINK
+    /// A file_sink that collects memory ranges in a buffer and writes them in large pieces (write-behind). The buffer
+    /// is written when it is full, before every flush and seek element and in the destructor. Errors of the write in
+    /// the destructor are lost, so append a flush element at the end to learn about them. After a failed write it is
+    /// unknown how much of the data has reached the file, so the content of the file is undefined then.
+    struct buffered_file_sink
+    {
+        typedef file_sink_element element_type;
+        typedef boost::system::error_code error_type;
+
+        /// the alignment of the buffer, suitable for files opened with O_DIRECT
+        static std::size_t const buffer_alignment = 4096;
+
+        static std::size_t const default_buffer_size = 64 * 1024;
+
+        buffered_file_sink() BOOST_NOEXCEPT : m_capacity(0), m_used(0)
+        {
+        }
+
+        explicit buffered_file_sink(Si::native_file_descriptor destination,
+                                    std::size_t buffer_size = default_buffer_size)
+            : m_next(destination)
+            , m_buffer(detail::allocate_aligned(buffer_size, buffer_alignment))
+            , m_capacity(buffer_size)
+            , m_used(0)
+        {
+            assert(buffer_size > 0);
+        }
+
+        buffered_file_sink(buffered_file_sink &&other) BOOST_NOEXCEPT : m_next(other.m_next),
+                                                                        m_buffer(std::move(other.m_buffer)),
+                                                                        m_capacity(other.m_capacity),
+                                                                        m_used(other.m_used)
+        {
+            other.m_capacity = 0;
+            other.m_used = 0;
+        }
+
+        buffered_file_sink &operator=(buffered_file_sink &&other) BOOST_NOEXCEPT
+        {
+            if (this != &other)
+            {
+                flush_buffer();
+                m_next = other.m_next;
+                m_buffer = std::move(other.m_buffer);
+                m_capacity = other.m_capacity;
+                m_used = other.m_used;
+                other.m_capacity = 0;
+                other.m_used = 0;
+            }
+            return *this;
+        }
+
+        ~buffered_file_sink() BOOST_NOEXCEPT
+        {
+            flush_buffer();
+        }
+
+        error_type append(Si::iterator_range<element_type const *> data)
+        {
+            for (element_type const &element : data)
+            {
+                Si::memory_range const *const content = Si::try_get_ptr<Si::memory_range>(element);
+                if (content)
+                {
+                    error_type const error = append_content(*content);
+                    if (error)
+                    {
+                        return error;
+                    }
+                    continue;
+                }
+                error_type error = flush_buffer();
+                if (error)
+                {
+                    return error;
+                }
+                error = m_next.append(Si::make_iterator_range(&element, &element + 1));
+                if (error)
+                {
+                    return error;
+                }
+            }
+            return error_type();
+        }
+
+        /// Writes the buffered data to the file without waiting for the storage device (no fdatasync). The buffer is
+        /// emptied even if this fails, because a part of it may have been written before the error, and writing it
+        /// again would duplicate that part.
+        error_type flush_buffer()
+        {
+            if (m_used == 0)
+            {
+                return error_type();
+            }
+            element_type const buffered = Si::make_memory_range(static_cast<char const *>(m_buffer.get()), m_used);
+            m_used = 0;
+            return m_next.append(Si::make_iterator_range(&buffered, &buffered + 1));
+        }
+
+#ifndef _WIN32
+        /// see file_sink::set_durability_coordinator
+        void set_durability_coordinator(durability_coordinator *coordinator) BOOST_NOEXCEPT
+        {
+            m_next.set_durability_coordinator(coordinator);
+        }
+#endif
+
+        std::size_t buffered_size() const BOOST_NOEXCEPT
+        {
+            return m_used;
+        }
+
+    private:
+        file_sink m_next;
+        detail::aligned_buffer m_buffer;
+        std::size_t m_capacity;
+        std::size_t m_used;
+
+        error_type append_content(Si::memory_range const &content)
+        {
+            char const *next = content.begin();
+            std::size_t left = static_cast<std::size_t>(content.size());
+            if (left >= m_capacity)
+            {
+                // Copying a large piece would not save a system call, so it is written together with the buffer.
+                std::array<element_type, 2> const pieces = {
+                    {Si::make_memory_range(static_cast<char const *>(m_buffer.get()), m_used), content}};
+                bool const is_buffer_empty = (m_used == 0);
+                // dropped on failure, too, like in flush_buffer
+                m_used = 0;
+                return m_next.append(Si::make_iterator_range(pieces.data() + is_buffer_empty, pieces.data() + 2));
+            }
+            while (left > 0)
+            {
+                std::size_t const copied = (std::min)(left, m_capacity - m_used);
+                std::copy_n(next, copied, m_buffer.get() + m_used);
+                m_used += copied;
+                next += copied;
+                left -= copied;
+                if (m_used == m_capacity)
+                {
+                    error_type const error = flush_buffer();
+                    if (error)
+                    {
+                        return error;
+                    }
+                }
+            }
+            return error_type();
+        }
+
+        SILICIUM_DELETED_FUNCTION(buffered_file_sink(buffered_file_sink const &))
+        SILICIUM_DELETED_FUNCTION(buffered_file_sink &operator=(buffered_file_sink const &))
+    };
+#endif
+}
+
+#endif
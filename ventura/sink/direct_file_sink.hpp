@@ -0,0 +1,170 @@
+#ifndef VENTURA_DIRECT_FILE_SINK_HPP
+#define VENTURA_DIRECT_FILE_SINK_HPP
+
+#include <ventura/aligned_buffer_pool.hpp>
+#include <ventura/open.hpp>
+#include <silicium/get_last_error.hpp>
+#include <silicium/sink/sink.hpp>
+#include <boost/system/error_code.hpp>
+#include <algorithm>
+
+#if VENTURA_HAS_DIRECT_IO
+#include <unistd.h>
+#endif
+
+namespace ventura
+{
+#if VENTURA_HAS_DIRECT_IO
+    /// A sink of characters for a file opened with overwrite_file_direct. All writes but the last one are whole
+    /// buffers from an aligned_buffer_pool, so addresses, sizes and offsets stay aligned as O_DIRECT requires. The
+    /// unaligned tail is written by finish after O_DIRECT has been turned off for the descriptor.
+    struct direct_file_sink
+    {
+        typedef char element_type;
+        typedef boost::system::error_code error_type;
+
+        direct_file_sink() BOOST_NOEXCEPT : m_destination(-1), m_alignment(1), m_used(0), m_finished(true)
+        {
+        }
+
+        /// @param destination has to be positioned at an aligned offset, usually the beginning
+        direct_file_sink(Si::native_file_descriptor destination, aligned_buffer_pool &buffers)
+            : m_destination(destination)
+            , m_buffer(buffers.acquire())
+            , m_alignment(buffers.alignment())
+            , m_used(0)
+            , m_finished(false)
+        {
+        }
+
+        direct_file_sink(direct_file_sink &&other) BOOST_NOEXCEPT : m_destination(other.m_destination),
+                                                                    m_buffer(std::move(other.m_buffer)),
+                                                                    m_alignment(other.m_alignment),
+                                                                    m_used(other.m_used),
+                                                                    m_finished(other.m_finished)
+        {
+            other.m_used = 0;
+            other.m_finished = true;
+        }
+
+        direct_file_sink &operator=(direct_file_sink &&other) BOOST_NOEXCEPT
+        {
+            if (this != &other)
+            {
+                finish();
+                m_destination = other.m_destination;
+                m_buffer = std::move(other.m_buffer);
+                m_alignment = other.m_alignment;
+                m_used = other.m_used;
+                m_finished = other.m_finished;
+                other.m_used = 0;
+                other.m_finished = true;
+            }
+            return *this;
+        }
+
+        /// Errors of the final write are lost here, so call finish explicitly to learn about them.
+        ~direct_file_sink() BOOST_NOEXCEPT
+        {
+            finish();
+        }
+
+        error_type append(Si::iterator_range<element_type const *> data)
+        {
+            if (m_finished)
+            {
+                return write_all(data.begin(), static_cast<std::size_t>(data.size()));
+            }
+            char const *next = data.begin();
+            std::size_t left = static_cast<std::size_t>(data.size());
+            while (left > 0)
+            {
+                std::size_t const copied = (std::min)(left, m_buffer.size() - m_used);
+                std::copy_n(next, copied, m_buffer.data() + m_used);
+                m_used += copied;
+                next += copied;
+                left -= copied;
+                if (m_used == m_buffer.size())
+                {
+                    error_type const error = write_all(m_buffer.data(), m_used);
+                    if (error)
+                    {
+                        return error;
+                    }
+                    m_used = 0;
+                }
+            }
+            return error_type();
+        }
+
+        /// Writes the rest of the buffer. The aligned part still bypasses the cache, the tail does not. O_DIRECT is
+        /// turned off for the descriptor in any case, so later appends of any size are written through without
+        /// buffering.
+        error_type finish()
+        {
+            if (m_finished)
+            {
+                return error_type();
+            }
+            std::size_t const aligned = m_used - (m_used % m_alignment);
+            error_type error = write_all(m_buffer.data(), aligned);
+            if (error)
+            {
+                return error;
+            }
+            std::copy(m_buffer.data() + aligned, m_buffer.data() + m_used, m_buffer.data());
+            m_used -= aligned;
+            error = disable_direct_io(m_destination);
+            if (error)
+            {
+                return error;
+            }
+            error = write_all(m_buffer.data(), m_used);
+            if (error)
+            {
+                return error;
+            }
+            m_used = 0;
+            m_finished = true;
+            m_buffer.release();
+            return error_type();
+        }
+
+        std::size_t buffered_size() const BOOST_NOEXCEPT
+        {
+            return m_used;
+        }
+
+    private:
+        Si::native_file_descriptor m_destination;
+        pooled_buffer m_buffer;
+        std::size_t m_alignment;
+        std::size_t m_used;
+        bool m_finished;
+
+        error_type write_all(char const *data, std::size_t size)
+        {
+            while (size > 0)
+            {
+                ssize_t const written = ::write(m_destination, data, size);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return Si::get_last_error();
+                }
+                data += written;
+                size -= static_cast<std::size_t>(written);
+            }
+            return error_type();
+        }
+
+        SILICIUM_DELETED_FUNCTION(direct_file_sink(direct_file_sink const &))
+        SILICIUM_DELETED_FUNCTION(direct_file_sink &operator=(direct_file_sink const &))
+    };
+#endif
+}
+
+#endif
@@ -6,12 +6,19 @@
 #include <silicium/variant.hpp>
 #include <silicium/file_handle.hpp>
 #include <silicium/memory_range.hpp>
+#include <silicium/optional.hpp>
+#include <ventura/access_pattern.hpp>
+#include <ventura/durability_coordinator.hpp>
 #include <ventura/flush.hpp>
 #include <ventura/file_operations.hpp>
 
 #ifdef _WIN32
 #include <silicium/win32/win32.hpp>
 #else
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
 #include <sys/uio.h>
 #include <unistd.h>
 #endif
@@ -20,6 +27,92 @@
 
 namespace ventura
 {
+#ifndef _WIN32
+    namespace detail
+    {
+#ifdef IOV_MAX
+        std::size_t const max_iovec_count = (IOV_MAX < 1024) ? IOV_MAX : 1024;
+#else
+        // the minimum that POSIX guarantees
+        std::size_t const max_iovec_count = 16;
+#endif
+
+        /// writes at least a prefix of the iovecs at the offset without using or changing the file cursor
+        inline ssize_t positional_writev(Si::native_file_descriptor destination, iovec const *vector,
+                                         std::size_t count, boost::uint64_t offset)
+        {
+#ifdef __linux__
+            return pwritev64(destination, vector, static_cast<int>(count), static_cast<off64_t>(offset));
+#elif defined(__FreeBSD__)
+            return pwritev(destination, vector, static_cast<int>(count), static_cast<off_t>(offset));
+#else
+            // the caller continues with the remaining iovecs
+            assert(count > 0);
+            (void)count;
+            return pwrite(destination, vector->iov_base, vector->iov_len, static_cast<off_t>(offset));
+#endif
+        }
+
+        /// @return 0 or an errno value
+        inline int allocate_space(Si::native_file_descriptor file, boost::uint64_t offset, boost::uint64_t length,
+                                  bool keep_size)
+        {
+#ifdef __linux__
+            if (fallocate64(file, keep_size ? FALLOC_FL_KEEP_SIZE : 0, static_cast<off64_t>(offset),
+                            static_cast<off64_t>(length)) < 0)
+            {
+                return errno;
+            }
+            return 0;
+#elif defined(__APPLE__)
+            (void)file;
+            (void)offset;
+            (void)length;
+            (void)keep_size;
+            return ENOTSUP;
+#else
+            if (keep_size)
+            {
+                return ENOTSUP;
+            }
+            return posix_fallocate(file, static_cast<off_t>(offset), static_cast<off_t>(length));
+#endif
+        }
+
+        /// @return 0 or an errno value
+        inline int deallocate_space(Si::native_file_descriptor file, boost::uint64_t offset, boost::uint64_t length)
+        {
+#ifdef __linux__
+            if (fallocate64(file, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off64_t>(offset),
+                            static_cast<off64_t>(length)) < 0)
+            {
+                return errno;
+            }
+            return 0;
+#else
+            (void)file;
+            (void)offset;
+            (void)length;
+            return ENOTSUP;
+#endif
+        }
+
+        /// @return 0 or an errno value
+        inline int truncate_to(Si::native_file_descriptor file, boost::uint64_t size)
+        {
+#ifdef __linux__
+            if (ftruncate64(file, static_cast<off64_t>(size)) < 0)
+#else
+            if (ftruncate(file, static_cast<off_t>(size)) < 0)
+#endif
+            {
+                return errno;
+            }
+            return 0;
+        }
+    }
+#endif
+
 #if VENTURA_HAS_FILE_SINK
     struct seek_set
     {
@@ -31,7 +124,41 @@ namespace ventura
         boost::int64_t from_current;
     };
 
-    typedef Si::variant<flush, Si::memory_range, seek_set, seek_add> file_sink_element;
+    /// Reserves disk space for a range of the file without changing its size (fallocate with FALLOC_FL_KEEP_SIZE) so
+    /// that extending writes neither fragment the file nor update the allocation metadata every time.
+    struct reserve_space
+    {
+        boost::uint64_t from_beginning;
+        boost::uint64_t length;
+    };
+
+    /// Frees the disk space of a range of the file, which then reads as zeros (FALLOC_FL_PUNCH_HOLE). The size of the
+    /// file does not change.
+    struct punch_hole
+    {
+        boost::uint64_t from_beginning;
+        boost::uint64_t length;
+    };
+
+    /// Sets the size of the file, cutting off the end or appending zeros. The cursor does not move.
+    struct truncate_file
+    {
+        boost::uint64_t size;
+    };
+
+    typedef Si::variant<flush, Si::memory_range, seek_set, seek_add, reserve_space, punch_hole, truncate_file>
+        file_sink_element;
+
+#ifndef _WIN32
+    /// Makes a file_sink write with pwritev at a cursor of its own instead of using the cursor of the file
+    /// descriptor. Seek elements then only move this cursor and cost no system call, and the descriptor can be shared
+    /// with other users of positional I/O. The file has to be seekable, so this does not work for pipes.
+    struct positional_writes
+    {
+        /// the initial position of the cursor of the sink
+        boost::uint64_t start;
+    };
+#endif
 
     struct file_sink
     {
@@ -39,14 +166,68 @@ namespace ventura
         typedef boost::system::error_code error_type;
 
         file_sink()
+#ifndef _WIN32
+            : m_durability(nullptr)
+#endif
         {
         }
 
         explicit file_sink(Si::native_file_descriptor destination)
             : m_destination(destination)
+#ifndef _WIN32
+            , m_durability(nullptr)
+#endif
+        {
+        }
+
+#ifndef _WIN32
+        file_sink(Si::native_file_descriptor destination, positional_writes mode)
+            : m_destination(destination)
+            , m_cursor(mode.start)
+            , m_durability(nullptr)
         {
         }
 
+        /// Makes flush elements wait for a group commit of the coordinator instead of syncing the file alone. Flushes
+        /// of many sinks and threads then share system calls. nullptr restores the default.
+        void set_durability_coordinator(durability_coordinator *coordinator) BOOST_NOEXCEPT
+        {
+            m_durability = coordinator;
+        }
+
+        /// Returns immediately. The handler is called by the coordinator when everything appended so far is durable,
+        /// so that a writer can continue while the commit is pending.
+        void request_commit(durability_coordinator::commit_handler on_committed)
+        {
+            assert(m_durability);
+            m_durability->request_sync(m_destination, std::move(on_committed));
+        }
+
+#if VENTURA_HAS_ACCESS_HINTS
+        /// Passes the pattern on to the system (posix_fadvise). With access_pattern::streaming, the sink also starts
+        /// the writeback of what it has written every few megabytes and drops the pages written before from the page
+        /// cache.
+        void set_access_pattern(access_pattern pattern)
+        {
+            detail::advise_pattern(m_destination, pattern);
+            if (pattern != access_pattern::streaming)
+            {
+                m_write_behind = Si::none;
+            }
+            else if (!m_write_behind)
+            {
+                m_write_behind = detail::write_behind();
+            }
+        }
+#endif
+
+        /// the position of the next write in the positional mode, none otherwise
+        Si::optional<boost::uint64_t> cursor() const
+        {
+            return m_cursor;
+        }
+#endif
+
         error_type append(Si::iterator_range<element_type const *> data)
         {
             return append_impl(data);
@@ -54,6 +235,13 @@ namespace ventura
 
     private:
         Si::native_file_descriptor m_destination;
+#ifndef _WIN32
+        Si::optional<boost::uint64_t> m_cursor;
+        durability_coordinator *m_durability;
+#if VENTURA_HAS_ACCESS_HINTS
+        Si::optional<detail::write_behind> m_write_behind;
+#endif
+#endif
 
 #ifdef _WIN32
         error_type append_impl(Si::iterator_range<element_type const *> data)
@@ -108,6 +296,46 @@ namespace ventura
                                                  return error_type();
                                              }
                                              return Si::get_last_error();
+                                         },
+                                         [this](reserve_space const request) -> error_type
+                                         {
+                                             // Windows can only reserve space from the beginning of the file.
+                                             FILE_ALLOCATION_INFO allocation;
+                                             allocation.AllocationSize.QuadPart =
+                                                 request.from_beginning + request.length;
+                                             if (SetFileInformationByHandle(m_destination, FileAllocationInfo,
+                                                                            &allocation, sizeof(allocation)))
+                                             {
+                                                 return error_type();
+                                             }
+                                             return Si::get_last_error();
+                                         },
+                                         [](punch_hole) -> error_type
+                                         {
+                                             return error_type(ERROR_NOT_SUPPORTED, boost::system::system_category());
+                                         },
+                                         [this](truncate_file const request) -> error_type
+                                         {
+                                             LARGE_INTEGER const zero = {};
+                                             LARGE_INTEGER position;
+                                             if (!SetFilePointerEx(m_destination, zero, &position, FILE_CURRENT))
+                                             {
+                                                 return Si::get_last_error();
+                                             }
+                                             LARGE_INTEGER size;
+                                             size.QuadPart = request.size;
+                                             if (!SetFilePointerEx(m_destination, size, NULL, FILE_BEGIN) ||
+                                                 !SetEndOfFile(m_destination))
+                                             {
+                                                 error_type const error = Si::get_last_error();
+                                                 SetFilePointerEx(m_destination, position, NULL, FILE_BEGIN);
+                                                 return error;
+                                             }
+                                             if (!SetFilePointerEx(m_destination, position, NULL, FILE_BEGIN))
+                                             {
+                                                 return Si::get_last_error();
+                                             }
+                                             return error_type();
                                          });
         }
 #else
@@ -138,22 +366,18 @@ namespace ventura
             for (; i < data.size(); ++i)
             {
                 auto &element = data[i];
-                size_t const max_streak_length = 1024;
                 if (Si::try_get_ptr<Si::memory_range>(element))
                 {
+                    // write_vector splits long streaks into chunks itself
                     if (write_streak_length)
                     {
                         ++(*write_streak_length);
-                        if (*write_streak_length < max_streak_length)
-                        {
-                            continue;
-                        }
                     }
                     else
                     {
                         write_streak_length = 1;
-                        continue;
                     }
+                    continue;
                 }
 
                 error_type err = flush_writes();
@@ -176,6 +400,10 @@ namespace ventura
             return Si::visit<error_type>(element,
                                          [this](flush) -> error_type
                                          {
+                                             if (m_durability)
+                                             {
+                                                 return m_durability->sync(m_destination);
+                                             }
                                              if (
 #ifdef __APPLE__
                                                  fsync
@@ -194,10 +422,21 @@ namespace ventura
                                          },
                                          [this](seek_set const request) -> error_type
                                          {
+                                             end_write_run();
+                                             if (m_cursor)
+                                             {
+                                                 *m_cursor = request.from_beginning;
+                                                 return error_type();
+                                             }
                                              return seek_absolute(m_destination, request.from_beginning);
                                          },
                                          [this](seek_add const request) -> error_type
                                          {
+                                             end_write_run();
+                                             if (m_cursor)
+                                             {
+                                                 return move_cursor(request.from_current);
+                                             }
                                              if (
 #ifdef __APPLE__
                                                  lseek
@@ -210,37 +449,187 @@ namespace ventura
                                                  return Si::get_last_error();
                                              }
                                              return error_type();
+                                         },
+                                         [this](reserve_space const request) -> error_type
+                                         {
+                                             return to_error(detail::allocate_space(
+                                                 m_destination, request.from_beginning, request.length, true));
+                                         },
+                                         [this](punch_hole const request) -> error_type
+                                         {
+                                             return to_error(detail::deallocate_space(
+                                                 m_destination, request.from_beginning, request.length));
+                                         },
+                                         [this](truncate_file const request) -> error_type
+                                         {
+                                             return to_error(detail::truncate_to(m_destination, request.size));
                                          });
         }
 
+        static error_type to_error(int error)
+        {
+            if (error == 0)
+            {
+                return error_type();
+            }
+            return error_type(error, boost::system::system_category());
+        }
+
+        error_type move_cursor(boost::int64_t distance)
+        {
+            boost::uint64_t const magnitude = (distance < 0) ? (0 - static_cast<boost::uint64_t>(distance))
+                                                             : static_cast<boost::uint64_t>(distance);
+            if ((distance < 0) ? (magnitude > *m_cursor)
+                               : (magnitude > ((std::numeric_limits<boost::uint64_t>::max)() - *m_cursor)))
+            {
+                return boost::system::error_code(EINVAL, boost::system::system_category());
+            }
+            *m_cursor = (distance < 0) ? (*m_cursor - magnitude) : (*m_cursor + magnitude);
+            return error_type();
+        }
+
         error_type write_piece(Si::memory_range const &content)
         {
-            Si::error_or<std::size_t> written = Si::write(m_destination, content);
-            if (!written.is_error())
+            if (m_cursor)
             {
-                assert(written.get() == static_cast<size_t>(content.size()));
+                iovec piece;
+                piece.iov_base = const_cast<void *>(static_cast<void const *>(content.begin()));
+                piece.iov_len = static_cast<std::size_t>(content.size());
+                return write_all_vectors(&piece, (piece.iov_len > 0) ? 1 : 0);
             }
-            return written.error();
+            char const *next = content.begin();
+            std::size_t left = static_cast<std::size_t>(content.size());
+            while (left > 0)
+            {
+                ssize_t const written = ::write(m_destination, next, left);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return Si::get_last_error();
+                }
+                next += written;
+                left -= static_cast<std::size_t>(written);
+                account_written(static_cast<std::size_t>(written));
+            }
+            return error_type();
         }
 
+        /// Writes a streak of memory ranges with as few writev calls as possible. The iovec array lives on the stack,
+        /// so long streaks are written in chunks of at most detail::max_iovec_count pieces.
         error_type write_vector(element_type const *begin, element_type const *end)
         {
-            std::vector<iovec> vector(static_cast<std::size_t>(std::distance(begin, end)));
-            for (size_t i = 0; i < vector.size(); ++i, ++begin)
+            std::array<iovec, detail::max_iovec_count> vector;
+            while (begin != end)
             {
-                Si::memory_range const &piece = *Si::try_get_ptr<Si::memory_range>(*begin);
-                vector[i].iov_base = const_cast<void *>(static_cast<void const *>(piece.begin()));
-                vector[i].iov_len = static_cast<std::size_t>(piece.size());
+                std::size_t count = 0;
+                for (; (begin != end) && (count < vector.size()); ++begin)
+                {
+                    Si::memory_range const &piece = *Si::try_get_ptr<Si::memory_range>(*begin);
+                    if (piece.empty())
+                    {
+                        continue;
+                    }
+                    vector[count].iov_base = const_cast<void *>(static_cast<void const *>(piece.begin()));
+                    vector[count].iov_len = static_cast<std::size_t>(piece.size());
+                    ++count;
+                }
+                error_type const error = write_all_vectors(vector.data(), count);
+                if (error)
+                {
+                    return error;
+                }
             }
-            assert(vector.size() <= static_cast<size_t>((std::numeric_limits<int>::max)()));
-            ssize_t rc = ::writev(m_destination, vector.data(), static_cast<int>(vector.size()));
-            if (rc < 0)
+            return error_type();
+        }
+
+        /// Modifies the iovecs to continue after partial writes. In the positional mode, the virtual cursor is advanced
+        /// by what has been written.
+        error_type write_all_vectors(iovec *vector, std::size_t count)
+        {
+            while (count > 0)
             {
-                return Si::get_last_error();
+                ssize_t const written = m_cursor ? detail::positional_writev(m_destination, vector, count, *m_cursor)
+                                                 : ::writev(m_destination, vector, static_cast<int>(count));
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return Si::get_last_error();
+                }
+                if (m_cursor)
+                {
+                    *m_cursor += static_cast<boost::uint64_t>(written);
+                }
+                account_written(static_cast<std::size_t>(written));
+                std::size_t unaccounted = static_cast<std::size_t>(written);
+                while ((count > 0) && (unaccounted >= vector->iov_len))
+                {
+                    unaccounted -= vector->iov_len;
+                    ++vector;
+                    --count;
+                }
+                if (unaccounted > 0)
+                {
+                    assert(count > 0);
+                    vector->iov_base = static_cast<char *>(vector->iov_base) + unaccounted;
+                    vector->iov_len -= unaccounted;
+                }
             }
-            // assume that everything has been written
             return error_type();
         }
+
+        void account_written(std::size_t bytes)
+        {
+#if VENTURA_HAS_ACCESS_HINTS
+            if (!m_write_behind || !m_write_behind->written(bytes))
+            {
+                return;
+            }
+            if (m_cursor)
+            {
+                m_write_behind->start(m_destination, *m_cursor);
+                return;
+            }
+            Si::optional<boost::uint64_t> const position = detail::current_offset(m_destination);
+            if (!position)
+            {
+                // not seekable, so there is nothing to write back or drop
+                m_write_behind = Si::none;
+                return;
+            }
+            m_write_behind->start(m_destination, *position);
+#else
+            (void)bytes;
+#endif
+        }
+
+        /// tells the write-behind where the contiguous writes before a seek have ended
+        void end_write_run()
+        {
+#if VENTURA_HAS_ACCESS_HINTS
+            if (!m_write_behind || !m_write_behind->is_in_run())
+            {
+                return;
+            }
+            if (m_cursor)
+            {
+                m_write_behind->jumping(*m_cursor);
+                return;
+            }
+            Si::optional<boost::uint64_t> const position = detail::current_offset(m_destination);
+            if (!position)
+            {
+                m_write_behind = Si::none;
+                return;
+            }
+            m_write_behind->jumping(*position);
+#endif
+        }
 #endif
     };
 
@@ -0,0 +1,378 @@
+#ifndef VENTURA_MMAP_SINK_HPP
+#define VENTURA_MMAP_SINK_HPP
+
+#include <ventura/file_size.hpp>
+#include <ventura/sink/file_sink.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+#if VENTURA_HAS_FILE_SINK && !defined(_WIN32)
+#define VENTURA_HAS_MMAP_SINK 1
+#else
+#define VENTURA_HAS_MMAP_SINK 0
+#endif
+
+namespace ventura
+{
+#if VENTURA_HAS_MMAP_SINK
+    /// A sink for the same elements as file_sink that copies the content into a shared mapping of the file instead of
+    /// calling write. Seeks only move a pointer, so formats that are written in random order need no system calls
+    /// except for the occasional growth of the file and the mapping. The file is grown in large steps and truncated to
+    /// what has actually been written by finish or the destructor. The file has to be opened for reading and writing.
+    struct mmap_sink
+    {
+        typedef file_sink_element element_type;
+        typedef boost::system::error_code error_type;
+
+        /// the minimum number of bytes by which the file and the mapping grow
+        static std::size_t const minimum_growth = 1024 * 1024;
+
+        mmap_sink() BOOST_NOEXCEPT : m_file(-1),
+                                     m_populate(false),
+                                     m_mapping(nullptr),
+                                     m_capacity(0),
+                                     m_cursor(0),
+                                     m_end(0)
+        {
+        }
+
+        mmap_sink(mmap_sink &&other) BOOST_NOEXCEPT : m_file(other.m_file),
+                                                      m_populate(other.m_populate),
+                                                      m_mapping(other.m_mapping),
+                                                      m_capacity(other.m_capacity),
+                                                      m_cursor(other.m_cursor),
+                                                      m_end(other.m_end)
+        {
+            other.m_file = -1;
+            other.m_mapping = nullptr;
+            other.m_capacity = 0;
+        }
+
+        mmap_sink &operator=(mmap_sink &&other) BOOST_NOEXCEPT
+        {
+            if (this != &other)
+            {
+                finish();
+                m_file = other.m_file;
+                m_populate = other.m_populate;
+                m_mapping = other.m_mapping;
+                m_capacity = other.m_capacity;
+                m_cursor = other.m_cursor;
+                m_end = other.m_end;
+                other.m_file = -1;
+                other.m_mapping = nullptr;
+                other.m_capacity = 0;
+            }
+            return *this;
+        }
+
+        /// Errors of the final truncation are lost here, so call finish explicitly to learn about them.
+        ~mmap_sink() BOOST_NOEXCEPT
+        {
+            finish();
+        }
+
+        /// Maps the existing content of the file. The cursor starts at the beginning and the existing content is kept.
+        /// @param populate prefaults the page tables of the mapping (MAP_POPULATE on Linux) so that the first write to
+        /// every page does not cause a page fault
+        SILICIUM_USE_RESULT
+        static Si::error_or<mmap_sink> open(Si::native_file_descriptor file, bool populate = false)
+        {
+            Si::error_or<Si::optional<boost::uint64_t>> const size = file_size(file);
+            if (size.is_error())
+            {
+                return size.error();
+            }
+            if (!size.get())
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::invalid_seek);
+            }
+            mmap_sink result;
+            result.m_file = file;
+            result.m_populate = populate;
+            result.m_end = *size.get();
+            if (*size.get() > 0)
+            {
+                error_type const error = result.map(*size.get());
+                if (error)
+                {
+                    result.m_file = -1;
+                    return error;
+                }
+            }
+            return std::move(result);
+        }
+
+        error_type append(Si::iterator_range<element_type const *> data)
+        {
+            for (element_type const &element : data)
+            {
+                error_type const error = append_one(element);
+                if (error)
+                {
+                    return error;
+                }
+            }
+            return error_type();
+        }
+
+        /// Unmaps the file and truncates it to the end of what has been written. Later appends are not possible.
+        error_type finish()
+        {
+            if (m_file < 0)
+            {
+                return error_type();
+            }
+            unmap();
+            int const error = detail::truncate_to(m_file, m_end);
+            m_file = -1;
+            return to_error(error);
+        }
+
+        boost::uint64_t cursor() const BOOST_NOEXCEPT
+        {
+            return m_cursor;
+        }
+
+        /// the size that the file will have after finish
+        boost::uint64_t written_size() const BOOST_NOEXCEPT
+        {
+            return m_end;
+        }
+
+    private:
+        Si::native_file_descriptor m_file;
+        bool m_populate;
+        char *m_mapping;
+        std::size_t m_capacity;
+        boost::uint64_t m_cursor;
+        boost::uint64_t m_end;
+
+        error_type append_one(element_type const &element)
+        {
+            assert(m_file >= 0);
+            return Si::visit<error_type>(element,
+                                         [this](flush) -> error_type
+                                         {
+                                             return sync();
+                                         },
+                                         [this](Si::memory_range const &content) -> error_type
+                                         {
+                                             return write(content);
+                                         },
+                                         [this](seek_set const request) -> error_type
+                                         {
+                                             m_cursor = request.from_beginning;
+                                             return error_type();
+                                         },
+                                         [this](seek_add const request) -> error_type
+                                         {
+                                             return move_cursor(request.from_current);
+                                         },
+                                         [this](reserve_space const request) -> error_type
+                                         {
+                                             // the mapping can only cover space that belongs to the file
+                                             return reserve(request.from_beginning, request.length);
+                                         },
+                                         [this](punch_hole const request) -> error_type
+                                         {
+                                             return to_error(detail::deallocate_space(
+                                                 m_file, request.from_beginning, request.length));
+                                         },
+                                         [this](truncate_file const request) -> error_type
+                                         {
+                                             return truncate(request.size);
+                                         });
+        }
+
+        static error_type to_error(int error)
+        {
+            if (error == 0)
+            {
+                return error_type();
+            }
+            return error_type(error, boost::system::system_category());
+        }
+
+        error_type write(Si::memory_range const &content)
+        {
+            std::size_t const size = static_cast<std::size_t>(content.size());
+            if (size == 0)
+            {
+                return error_type();
+            }
+            if (m_cursor > ((std::numeric_limits<boost::uint64_t>::max)() - size))
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::file_too_large);
+            }
+            boost::uint64_t const end = m_cursor + size;
+            error_type const error = grow(end);
+            if (error)
+            {
+                return error;
+            }
+            std::memcpy(m_mapping + static_cast<std::size_t>(m_cursor), content.begin(), size);
+            m_cursor = end;
+            m_end = (std::max)(m_end, end);
+            return error_type();
+        }
+
+        error_type move_cursor(boost::int64_t distance)
+        {
+            boost::uint64_t const magnitude = (distance < 0) ? (0 - static_cast<boost::uint64_t>(distance))
+                                                             : static_cast<boost::uint64_t>(distance);
+            if ((distance < 0) ? (magnitude > m_cursor)
+                               : (magnitude > ((std::numeric_limits<boost::uint64_t>::max)() - m_cursor)))
+            {
+                return boost::system::error_code(EINVAL, boost::system::system_category());
+            }
+            m_cursor = (distance < 0) ? (m_cursor - magnitude) : (m_cursor + magnitude);
+            return error_type();
+        }
+
+        error_type sync()
+        {
+            if (m_end == 0)
+            {
+                return error_type();
+            }
+            // MS_SYNC writes the dirty pages of the mapping and waits for the device like fdatasync
+            if (msync(m_mapping, static_cast<std::size_t>(m_end), MS_SYNC) < 0)
+            {
+                return Si::get_last_error();
+            }
+            return error_type();
+        }
+
+        error_type reserve(boost::uint64_t from_beginning, boost::uint64_t length)
+        {
+            if (from_beginning > ((std::numeric_limits<boost::uint64_t>::max)() - length))
+            {
+                return boost::system::errc::make_error_code(boost::system::errc::file_too_large);
+            }
+            return grow(from_beginning + length);
+        }
+
+        error_type truncate(boost::uint64_t size)
+        {
+            if (size < m_capacity)
+            {
+                // Truncating and growing again zeroes the cut off part without invalidating the mapping.
+                int error = detail::truncate_to(m_file, size);
+                if (error == 0)
+                {
+                    error = detail::truncate_to(m_file, m_capacity);
+                }
+                if (error != 0)
+                {
+                    return to_error(error);
+                }
+            }
+            else
+            {
+                error_type const error = grow(size);
+                if (error)
+                {
+                    return error;
+                }
+            }
+            m_end = size;
+            return error_type();
+        }
+
+        /// makes the file and the mapping at least end bytes large
+        error_type grow(boost::uint64_t end)
+        {
+            if (end <= m_capacity)
+            {
+                return error_type();
+            }
+            if (end > (std::numeric_limits<std::size_t>::max)())
+            {
+                // does not fit into the address space
+                return boost::system::errc::make_error_code(boost::system::errc::file_too_large);
+            }
+            std::size_t const page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            boost::uint64_t capacity = (std::max)(end, static_cast<boost::uint64_t>(m_capacity) * 2u);
+            capacity = (std::max)(capacity, static_cast<boost::uint64_t>(m_capacity) + minimum_growth);
+            capacity = (capacity + page_size - 1) / page_size * page_size;
+            capacity = (std::min)(capacity, static_cast<boost::uint64_t>((std::numeric_limits<std::size_t>::max)()));
+            int error = detail::allocate_space(m_file, m_capacity, capacity - m_capacity, false);
+            if ((error == ENOTSUP) || (error == EOPNOTSUPP) || (error == EINVAL))
+            {
+                // The file system cannot preallocate (posix_fallocate reports EINVAL for that on some systems). The
+                // file becomes sparse until the pages are written.
+                error = detail::truncate_to(m_file, capacity);
+            }
+            if (error != 0)
+            {
+                return to_error(error);
+            }
+            return remap(static_cast<std::size_t>(capacity));
+        }
+
+        error_type remap(std::size_t capacity)
+        {
+            if (!m_mapping)
+            {
+                return map(capacity);
+            }
+#ifdef __linux__
+            if (!m_populate)
+            {
+                void *const moved = mremap(m_mapping, m_capacity, capacity, MREMAP_MAYMOVE);
+                if (moved == MAP_FAILED)
+                {
+                    return Si::get_last_error();
+                }
+                m_mapping = static_cast<char *>(moved);
+                m_capacity = capacity;
+                return error_type();
+            }
+#endif
+            unmap();
+            return map(capacity);
+        }
+
+        error_type map(std::size_t capacity)
+        {
+            assert(!m_mapping);
+            int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+            if (m_populate)
+            {
+                flags |= MAP_POPULATE;
+            }
+#endif
+            void *const mapping = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, flags, m_file, 0);
+            if (mapping == MAP_FAILED)
+            {
+                return Si::get_last_error();
+            }
+            m_mapping = static_cast<char *>(mapping);
+            m_capacity = capacity;
+            return error_type();
+        }
+
+        void unmap() BOOST_NOEXCEPT
+        {
+            if (m_mapping)
+            {
+                munmap(m_mapping, m_capacity);
+                m_mapping = nullptr;
+            }
+            m_capacity = 0;
+        }
+
+        SILICIUM_DELETED_FUNCTION(mmap_sink(mmap_sink const &))
+        SILICIUM_DELETED_FUNCTION(mmap_sink &operator=(mmap_sink const &))
+    };
+#endif
+}
+
+#endif
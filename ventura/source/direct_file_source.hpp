@@ -0,0 +1,44 @@
+#ifndef VENTURA_DIRECT_FILE_SOURCE_HPP
+#define VENTURA_DIRECT_FILE_SOURCE_HPP
+
+#include <ventura/aligned_buffer_pool.hpp>
+#include <ventura/open.hpp>
+#include <ventura/source/file_source.hpp>
+#include <memory>
+
+namespace ventura
+{
+#if VENTURA_HAS_DIRECT_IO
+    /// Like make_file_source, but for a file opened with open_reading_direct. Every read fills the whole pooled
+    /// buffer, so the offsets stay aligned until the short read at the end of the file. The buffer goes back to the
+    /// pool when the source is destroyed.
+    inline auto make_direct_file_source(Si::native_file_descriptor file, pooled_buffer read_buffer)
+#if !SILICIUM_COMPILER_HAS_AUTO_RETURN_TYPE
+        -> Si::generator_source<std::function<Si::optional<file_read_result>()>>
+#endif
+    {
+        // std::function needs a copyable function object
+        std::shared_ptr<pooled_buffer> const buffer = std::make_shared<pooled_buffer>(std::move(read_buffer));
+        return Si::make_generator_source(
+#if !SILICIUM_COMPILER_HAS_AUTO_RETURN_TYPE
+            std::function<Si::optional<file_read_result>()>
+#endif
+            ([file, buffer]() -> Si::optional<file_read_result>
+             {
+                 Si::error_or<std::size_t> read_result = read(file, buffer->range());
+                 if (read_result.is_error())
+                 {
+                     return file_read_result(read_result.error());
+                 }
+                 else if (read_result.get() == 0)
+                 {
+                     return Si::none;
+                 }
+                 return file_read_result(
+                     Si::make_memory_range(buffer->data(), buffer->data() + read_result.get()));
+             }));
+    }
+#endif
+}
+
+#endif
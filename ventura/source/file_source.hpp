@@ -7,10 +7,14 @@
 #include <silicium/config.hpp>
 #include <silicium/memory_range.hpp>
 #include <silicium/file_handle.hpp>
+#include <ventura/access_pattern.hpp>
+#include <ventura/detail/read_loop.hpp>
 #include <boost/system/error_code.hpp>
+#include <algorithm>
+#include <cstring>
 #include <functional>
 
-#ifdef __linux__
+#ifndef _WIN32
 #include <unistd.h>
 #endif
 
@@ -18,6 +22,130 @@ namespace ventura
 {
     typedef Si::error_or<Si::memory_range> file_read_result;
 
+    /// Reads a file through a buffer of the caller like make_file_source, but as a concrete type without std::function
+    /// and without wrapping every piece in an optional, so that the compiler can inline reads into parsing loops.
+    struct file_source
+    {
+        typedef char element_type;
+
+        file_source() BOOST_NOEXCEPT : m_file(), m_next(nullptr), m_end(nullptr)
+        {
+        }
+
+        file_source(Si::native_file_descriptor file, Si::iterator_range<char *> read_buffer) BOOST_NOEXCEPT
+            : m_file(file),
+              m_buffer(read_buffer),
+              m_next(read_buffer.begin()),
+              m_end(read_buffer.begin())
+        {
+            assert(!read_buffer.empty());
+        }
+
+        /// Returns what is left in the buffer or reads the next piece into it.
+        /// @return an empty range at the end of the file
+        SILICIUM_USE_RESULT
+        file_read_result next()
+        {
+            if (m_next == m_end)
+            {
+                if (m_pending_error)
+                {
+                    return take_pending_error();
+                }
+                Si::error_or<std::size_t> const read =
+                    detail::read_some(m_file, m_buffer.begin(), static_cast<std::size_t>(m_buffer.size()));
+                if (read.is_error())
+                {
+                    return read.error();
+                }
+                m_next = m_buffer.begin();
+                m_end = m_next + read.get();
+            }
+            Si::memory_range const piece = Si::make_memory_range(m_next, m_end);
+            m_next = m_end;
+            return piece;
+        }
+
+        /// Fills the destination unless the file ends earlier. What does not fit into the buffer is read directly into
+        /// the destination without copying. When reading fails after something has been copied, the number of bytes
+        /// copied is returned and the error is reported by the next call of read_into or next.
+        /// @return the number of bytes copied, which is less than the size of the destination only at the end or
+        /// before an error
+        SILICIUM_USE_RESULT
+        Si::error_or<std::size_t> read_into(Si::iterator_range<char *> destination)
+        {
+            char *next = destination.begin();
+            char *const end = destination.end();
+            for (;;)
+            {
+                std::size_t const buffered = (std::min)(static_cast<std::size_t>(m_end - m_next),
+                                                        static_cast<std::size_t>(end - next));
+                if (buffered > 0)
+                {
+                    std::memcpy(next, m_next, buffered);
+                    m_next += buffered;
+                    next += buffered;
+                }
+                if (next == end)
+                {
+                    break;
+                }
+                assert(m_next == m_end);
+                bool const direct = (static_cast<std::size_t>(end - next) >= static_cast<std::size_t>(m_buffer.size()));
+                char *const target = direct ? next : m_buffer.begin();
+                std::size_t const wanted =
+                    direct ? static_cast<std::size_t>(end - next) : static_cast<std::size_t>(m_buffer.size());
+                Si::error_or<std::size_t> const read = m_pending_error
+                                                           ? Si::error_or<std::size_t>(take_pending_error())
+                                                           : detail::read_some(m_file, target, wanted);
+                if (read.is_error())
+                {
+                    if (next == destination.begin())
+                    {
+                        return read.error();
+                    }
+                    m_pending_error = read.error();
+                    break;
+                }
+                if (read.get() == 0)
+                {
+                    break;
+                }
+                if (direct)
+                {
+                    next += read.get();
+                }
+                else
+                {
+                    m_next = m_buffer.begin();
+                    m_end = m_next + read.get();
+                }
+            }
+            return static_cast<std::size_t>(next - destination.begin());
+        }
+
+        Si::native_file_descriptor handle() const BOOST_NOEXCEPT
+        {
+            return m_file;
+        }
+
+    private:
+        Si::native_file_descriptor m_file;
+        Si::iterator_range<char *> m_buffer;
+        char *m_next;
+        char *m_end;
+
+        /// an error that occurred after read_into had already copied something
+        boost::system::error_code m_pending_error;
+
+        boost::system::error_code take_pending_error() BOOST_NOEXCEPT
+        {
+            boost::system::error_code const error = m_pending_error;
+            m_pending_error = boost::system::error_code();
+            return error;
+        }
+    };
+
     inline auto make_file_source(Si::native_file_descriptor file, Si::iterator_range<char *> read_buffer)
 #if !SILICIUM_COMPILER_HAS_AUTO_RETURN_TYPE
         -> Si::generator_source<std::function<Si::optional<file_read_result>()>>
@@ -42,6 +170,66 @@ namespace ventura
                      Si::make_memory_range(read_buffer.begin(), read_buffer.begin() + read_result.get()));
              }));
     }
+
+    /// Like the other make_file_source, but the pattern is passed on to the system. A sequential or streaming source
+    /// requests the data ahead of the reader (POSIX_FADV_WILLNEED), and a streaming source drops what it has read
+    /// from the page cache.
+    inline auto make_file_source(Si::native_file_descriptor file, Si::iterator_range<char *> read_buffer,
+                                 access_pattern pattern)
+#if !SILICIUM_COMPILER_HAS_AUTO_RETURN_TYPE
+        -> Si::generator_source<std::function<Si::optional<file_read_result>()>>
+#endif
+    {
+#if VENTURA_HAS_ACCESS_HINTS
+        detail::advise_pattern(file, pattern);
+        // the hints need the position in the file, which pipes do not have
+        Si::optional<boost::uint64_t> const start =
+            (pattern == access_pattern::normal) ? Si::optional<boost::uint64_t>() : detail::current_offset(file);
+        bool const hinting = !!start;
+        boost::uint64_t position = hinting ? *start : 0;
+        boost::uint64_t requested_until = position;
+        boost::uint64_t dropped_until = position;
+        boost::uint64_t const window =
+            (std::max)(detail::readahead_window, static_cast<boost::uint64_t>(read_buffer.size()));
+#else
+        (void)pattern;
+#endif
+        return Si::make_generator_source(
+#if !SILICIUM_COMPILER_HAS_AUTO_RETURN_TYPE
+            std::function<Si::optional<file_read_result>()>
+#endif
+            ([=]() mutable -> Si::optional<file_read_result>
+             {
+#if VENTURA_HAS_ACCESS_HINTS
+                 if (hinting && ((position + static_cast<boost::uint64_t>(read_buffer.size())) > requested_until))
+                 {
+                     // requesting a whole window at once keeps the number of additional system calls low
+                     boost::uint64_t const from = (std::max)(position, requested_until);
+                     detail::advise(file, from, window, POSIX_FADV_WILLNEED);
+                     requested_until = from + window;
+                 }
+#endif
+                 Si::error_or<std::size_t> read_result = read(file, read_buffer);
+                 if (read_result.is_error())
+                 {
+                     return file_read_result(read_result.error());
+                 }
+                 else if (read_result.get() == 0)
+                 {
+                     return Si::none;
+                 }
+#if VENTURA_HAS_ACCESS_HINTS
+                 position += read_result.get();
+                 if (hinting && (pattern == access_pattern::streaming) && ((position - dropped_until) >= window))
+                 {
+                     detail::advise(file, dropped_until, position - dropped_until, POSIX_FADV_DONTNEED);
+                     dropped_until = position;
+                 }
+#endif
+                 return file_read_result(
+                     Si::make_memory_range(read_buffer.begin(), read_buffer.begin() + read_result.get()));
+             }));
+    }
 }
 
 #endif
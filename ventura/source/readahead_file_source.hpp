@@ -0,0 +1,176 @@
+#ifndef VENTURA_READAHEAD_FILE_SOURCE_HPP
+#define VENTURA_READAHEAD_FILE_SOURCE_HPP
+
+#include <ventura/access_pattern.hpp>
+#include <ventura/detail/read_loop.hpp>
+#include <ventura/source/file_source.hpp>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ventura
+{
+    namespace detail
+    {
+        /// The buffers of a readahead file source. A thread fills the free ones while the consumer processes the
+        /// content of the buffer it has received last.
+        struct readahead_state
+        {
+            readahead_state(Si::native_file_descriptor file, std::size_t buffer_size, std::size_t buffer_count)
+                : m_file(file)
+                , m_buffers(buffer_count, std::vector<char>(buffer_size))
+                , m_stopping(false)
+                , m_finished(false)
+            {
+                assert(buffer_size > 0);
+                assert(buffer_count >= 2);
+                for (std::size_t i = 0; i < buffer_count; ++i)
+                {
+                    m_free.push_back(i);
+                }
+                m_worker = std::thread([this]()
+                                       {
+                                           fill();
+                                       });
+            }
+
+            /// Waits for the read that is currently in progress. That can take long for a pipe without data.
+            ~readahead_state()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_changed.notify_all();
+                m_worker.join();
+            }
+
+            /// gives the buffer of the previous call back to the reading thread
+            Si::optional<file_read_result> next()
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_consumed)
+                {
+                    m_free.push_back(*m_consumed);
+                    m_consumed = Si::none;
+                    m_changed.notify_all();
+                }
+                if (m_finished)
+                {
+                    return Si::none;
+                }
+                m_changed.wait(lock, [this]()
+                               {
+                                   return !m_filled.empty();
+                               });
+                filled const received = m_filled.front();
+                m_filled.pop_front();
+                if (received.error)
+                {
+                    m_finished = true;
+                    return file_read_result(received.error);
+                }
+                if (received.size == 0)
+                {
+                    m_finished = true;
+                    return Si::none;
+                }
+                m_consumed = received.buffer;
+                char const *const content = m_buffers[received.buffer].data();
+                return file_read_result(Si::make_memory_range(content, content + received.size));
+            }
+
+        private:
+            struct filled
+            {
+                std::size_t buffer;
+                std::size_t size;
+                boost::system::error_code error;
+            };
+
+            Si::native_file_descriptor m_file;
+
+            /// never resized, so the thread can fill a buffer without holding the lock
+            std::vector<std::vector<char>> m_buffers;
+
+            std::mutex m_mutex;
+            std::condition_variable m_changed;
+            std::vector<std::size_t> m_free;
+            std::deque<filled> m_filled;
+            Si::optional<std::size_t> m_consumed;
+            bool m_stopping;
+            bool m_finished;
+            std::thread m_worker;
+
+            void fill()
+            {
+                for (;;)
+                {
+                    std::size_t buffer;
+                    {
+                        std::unique_lock<std::mutex> lock(m_mutex);
+                        m_changed.wait(lock, [this]()
+                                       {
+                                           return m_stopping || !m_free.empty();
+                                       });
+                        if (m_stopping)
+                        {
+                            return;
+                        }
+                        buffer = m_free.back();
+                        m_free.pop_back();
+                    }
+                    std::vector<char> &destination = m_buffers[buffer];
+                    Si::error_or<std::size_t> const read = read_some(m_file, destination.data(), destination.size());
+                    filled const result = {
+                        buffer, read.is_error() ? 0 : read.get(),
+                        read.is_error() ? read.error() : boost::system::error_code()};
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_filled.push_back(result);
+                    }
+                    m_changed.notify_all();
+                    if (result.error || (result.size == 0))
+                    {
+                        return;
+                    }
+                }
+            }
+
+            SILICIUM_DELETED_FUNCTION(readahead_state(readahead_state const &))
+            SILICIUM_DELETED_FUNCTION(readahead_state &operator=(readahead_state const &))
+        };
+    }
+
+    /// Like make_file_source, but a thread reads ahead into up to buffer_count buffers, or buffer_count - 1 while the
+    /// consumer is processing the piece it has received last, so that the latency of the device overlaps with the
+    /// computation. The content returned by the source is valid until the next read from it. The file has to stay
+    /// open as long as the source exists, and the source must not be destroyed while the thread is blocked reading
+    /// from a pipe that is never closed.
+    inline auto make_readahead_file_source(Si::native_file_descriptor file, std::size_t buffer_size = 256 * 1024,
+                                           std::size_t buffer_count = 3)
+#if !SILICIUM_COMPILER_HAS_AUTO_RETURN_TYPE
+        -> Si::generator_source<std::function<Si::optional<file_read_result>()>>
+#endif
+    {
+#if VENTURA_HAS_ACCESS_HINTS
+        detail::advise_pattern(file, access_pattern::sequential);
+#endif
+        // std::function needs a copyable function object
+        std::shared_ptr<detail::readahead_state> const state =
+            std::make_shared<detail::readahead_state>(file, buffer_size, buffer_count);
+        return Si::make_generator_source(
+#if !SILICIUM_COMPILER_HAS_AUTO_RETURN_TYPE
+            std::function<Si::optional<file_read_result>()>
+#endif
+            ([state]() -> Si::optional<file_read_result>
+             {
+                 return state->next();
+             }));
+    }
+}
+
+#endif